@@ -0,0 +1,122 @@
+/**
+ * @author Michele Bisignano
+ *
+ * Compares the cost of additively blending full frames with Color::add()
+ * against the packed RGBA8 Compositor kernels.
+ *
+ * Each "frame" blends LAYER_COUNT source buffers into one destination buffer,
+ * which is what the LightingManager does with one layer per active effect.
+ */
+#include "Core/Lighting/Compositor.h"
+#include "Core/Util/Color.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int LAYER_COUNT = 20;
+constexpr int FRAMES = 2000;
+
+// Keeps the optimizer from discarding the benchmarked work.
+volatile uint32_t g_sink = 0;
+
+struct Scene {
+    std::vector<std::vector<Color>> colorLayers;
+    std::vector<std::vector<PackedColor>> packedLayers;
+};
+
+Scene makeScene(size_t keyCount) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> dist(0, 160);
+    Scene scene;
+    for (int l = 0; l < LAYER_COUNT; ++l) {
+        std::vector<Color> layer;
+        std::vector<PackedColor> packed;
+        layer.reserve(keyCount);
+        packed.reserve(keyCount);
+        for (size_t k = 0; k < keyCount; ++k) {
+            const Color c(dist(rng), dist(rng), dist(rng));
+            layer.push_back(c);
+            packed.push_back(Compositor::pack(c));
+        }
+        scene.colorLayers.push_back(std::move(layer));
+        scene.packedLayers.push_back(std::move(packed));
+    }
+    return scene;
+}
+
+template<typename Fn>
+double nsPerFrame(Fn&& frame) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; ++f) {
+        frame();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / FRAMES;
+}
+
+void report(const char* name, size_t keyCount, double ns) {
+    const double blendsPerSecond = (static_cast<double>(keyCount) * LAYER_COUNT) / ns * 1e9;
+    std::printf("  %-12s %10.1f ns/frame %10.1f M key-blends/s\n", name, ns, blendsPerSecond / 1e6);
+}
+
+void runForKeyCount(size_t keyCount) {
+    const Scene scene = makeScene(keyCount);
+    std::printf("%zu keys x %d layers\n", keyCount, LAYER_COUNT);
+
+    // --- Reference: Color::add() per key ---
+    std::vector<Color> colorFrame(keyCount, Color(0, 0, 0));
+    const double colorNs = nsPerFrame([&] {
+        colorFrame.assign(keyCount, Color(0, 0, 0));
+        for (const auto& layer : scene.colorLayers) {
+            for (size_t k = 0; k < keyCount; ++k) {
+                colorFrame[k] = colorFrame[k].add(layer[k]);
+            }
+        }
+        g_sink = g_sink + static_cast<uint32_t>(colorFrame[keyCount / 2].getRed());
+    });
+    report("Color::add", keyCount, colorNs);
+
+    // --- Packed kernels ---
+    const Compositor::Kernel kernels[] = {
+        Compositor::Kernel::Scalar, Compositor::Kernel::SSE2, Compositor::Kernel::AVX2
+    };
+    std::vector<PackedColor> packedFrame(keyCount, 0);
+    for (Compositor::Kernel kernel : kernels) {
+        if (!Compositor::isSupported(kernel)) {
+            std::printf("  %-12s (not supported on this CPU)\n", Compositor::kernelName(kernel));
+            continue;
+        }
+        const double ns = nsPerFrame([&] {
+            std::fill(packedFrame.begin(), packedFrame.end(), 0u);
+            for (const auto& layer : scene.packedLayers) {
+                Compositor::addSaturate(kernel, packedFrame.data(), layer.data(), keyCount);
+            }
+            g_sink = g_sink + packedFrame[keyCount / 2];
+        });
+
+        // Every kernel must produce exactly what Color::add() produced.
+        bool matches = true;
+        for (size_t k = 0; k < keyCount; ++k) {
+            matches = matches && Compositor::unpack(packedFrame[k]) == colorFrame[k];
+        }
+        report(Compositor::kernelName(kernel), keyCount, ns);
+        if (!matches) {
+            std::printf("  ERROR: %s output differs from Color::add()\n", Compositor::kernelName(kernel));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("Compositor benchmark (active kernel: %s)\n\n",
+        Compositor::kernelName(Compositor::activeKernel()));
+    runForKeyCount(104);   // A full-size keyboard.
+    std::printf("\n");
+    runForKeyCount(4096);  // A large LED installation.
+    return 0;
+}
@@ -0,0 +1,348 @@
+/**
+ * @author Michele Bisignano
+ *
+ * Microbenchmarks of the core engine's hot paths, run headless on a full-size
+ * keyboard. Every result reports:
+ * - ns per iteration (one frame, one call, or one create/destroy pair);
+ * - heap allocations per iteration, counted by replacing the global operator
+ *   new in this program, so a regression that allocates per frame shows up
+ *   immediately;
+ * - a per-key throughput (millions of keys processed per second), the figure
+ *   to track over releases because it does not depend on the layout size.
+ */
+#include "Core/Effects/RippleEffect.h"
+#include "Core/Effects/SparksEffect.h"
+#include "Core/Effects/SpectrumEffect.h"
+#include "Core/Input/PcmRing.h"
+#include "Core/Keyboard/Keyboard.h"
+#include "Core/Lighting/EffectPool.h"
+#include "Core/Lighting/LightingManager.h"
+#include "Core/Output/LedEncoder.h"
+#include "Core/Util/Color.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+// Counts every heap allocation made through operator new (see below).
+uint64_t g_allocations = 0;
+
+// Keeps the optimizer from discarding the benchmarked work.
+volatile uint32_t g_sink = 0;
+
+constexpr int ITERATIONS = 20000;
+
+// Long enough for a ripple to cross the keyboard and fade out.
+constexpr int STEP_DURATION = 4;
+constexpr int PROPAGATION_DELAY = 2;
+constexpr int MAX_LIFETIME = 120;
+
+struct Result {
+    double ns;
+    double allocations;
+};
+
+/**
+ * @brief Runs `iteration(i)` ITERATIONS times, after a short warm-up.
+ */
+template<typename Fn>
+Result measure(Fn&& iteration) {
+    for (int i = 0; i < ITERATIONS / 10; ++i) {
+        iteration(i);
+    }
+
+    const uint64_t allocationsBefore = g_allocations;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        iteration(i);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return Result{
+        std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS,
+        static_cast<double>(g_allocations - allocationsBefore) / ITERATIONS
+    };
+}
+
+/**
+ * @brief Prints one result. `keysPerIteration` is the number of keys one iteration
+ *        processes, or 0 for tests that do not work per key.
+ */
+void report(const char* name, const char* unit, const Result& result, size_t keysPerIteration) {
+    std::printf("  %-30s %10.1f ns/%-6s %6.2f allocs/%-6s", name, result.ns, unit, result.allocations, unit);
+    if (keysPerIteration > 0) {
+        const double keysPerSecond = static_cast<double>(keysPerIteration) / result.ns * 1e9;
+        std::printf(" %10.1f M keys/s", keysPerSecond / 1e6);
+    }
+    std::printf("\n");
+}
+
+Color colorFor(int i) {
+    return Color(static_cast<uint8_t>(40 + i * 37), static_cast<uint8_t>(200 - i * 13), static_cast<uint8_t>(90 + i * 71));
+}
+
+void benchRippleEffect(const Keyboard& keyboard) {
+    const auto keys = keyboard.getKeys();
+    const Key& start = *keyboard.findKeyById(KeyCode::G);
+
+    // --- RippleEffect::update ---
+    // One ripple, restarted whenever it finishes, so every stage of its life is sampled.
+    EffectPool pool({ { EffectPool::slotSizeFor<RippleEffect>(keyboard), 1 } });
+    {
+        RippleEffect* effect = pool.create<RippleEffect>(keyboard, start, colorFor(0), STEP_DURATION, PROPAGATION_DELAY, MAX_LIFETIME);
+        const Result result = measure([&](int) {
+            effect->update();
+            if (effect->isFinished()) {
+                pool.destroy(effect);
+                effect = pool.create<RippleEffect>(keyboard, start, colorFor(0), STEP_DURATION, PROPAGATION_DELAY, MAX_LIFETIME);
+            }
+        });
+        pool.destroy(effect);
+        report("RippleEffect::update", "frame", result, keys.size());
+    }
+
+    // --- RippleEffect::getColorForKey ---
+    // Every key of a ripple frozen halfway across the keyboard.
+    {
+        RippleEffect* effect = pool.create<RippleEffect>(keyboard, start, colorFor(1), STEP_DURATION, PROPAGATION_DELAY, MAX_LIFETIME);
+        for (int f = 0; f < MAX_LIFETIME / 4; ++f) {
+            effect->update();
+        }
+        const Result result = measure([&](int) {
+            uint32_t sum = 0;
+            for (const Key& key : keys) {
+                sum += effect->getColorForKey(key).getRed();
+            }
+            g_sink = g_sink + sum;
+        });
+        pool.destroy(effect);
+        report("RippleEffect::getColorForKey", "frame", result, keys.size());
+    }
+}
+
+void benchLightingManager(Keyboard& keyboard, int effectCount) {
+    const auto keys = keyboard.getKeys();
+    LightingManager manager(&keyboard, static_cast<size_t>(effectCount) * 2);
+
+    // Starting one ripple every MAX_LIFETIME / effectCount frames keeps
+    // `effectCount` of them alive at any time, at staggered stages.
+    const int spawnInterval = MAX_LIFETIME / effectCount;
+    const Result result = measure([&](int frame) {
+        if (frame % spawnInterval == 0) {
+            const int n = frame / spawnInterval;
+            manager.addRippleEffect(keys[(n * 41) % keys.size()], colorFor(n), STEP_DURATION, PROPAGATION_DELAY, MAX_LIFETIME);
+        }
+        manager.update();
+        g_sink = g_sink + static_cast<uint32_t>(manager.getDirtyKeys().size());
+    });
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "LightingManager::update (%2d)", effectCount);
+    report(name, "frame", result, keys.size());
+}
+
+void benchRippleField(Keyboard& keyboard, int rippleCount) {
+    const auto keys = keyboard.getKeys();
+    LightingManager manager(&keyboard);
+
+    // The same staggered ripples as benchLightingManager(), all in the shared field.
+    const int spawnInterval = std::max(1, MAX_LIFETIME / rippleCount);
+    const int perSpawn = std::max(1, rippleCount / MAX_LIFETIME);
+    const Result result = measure([&](int frame) {
+        if (frame % spawnInterval == 0) {
+            for (int p = 0; p < perSpawn; ++p) {
+                const int n = frame / spawnInterval * perSpawn + p;
+                manager.addFieldRipple(keys[(n * 41) % keys.size()], colorFor(n), STEP_DURATION, PROPAGATION_DELAY, MAX_LIFETIME);
+            }
+        }
+        manager.update();
+        g_sink = g_sink + static_cast<uint32_t>(manager.getDirtyKeys().size());
+    });
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "Ripple field update (%4d)", rippleCount);
+    report(name, "frame", result, keys.size());
+}
+
+void benchSparks(const Keyboard& keyboard, size_t particleCount) {
+    const auto keys = keyboard.getKeys();
+    // Too large for the stack; created before measuring, in a pool slot.
+    EffectPool pool({ { EffectPool::slotSizeFor<SparksEffect>(keyboard), 1 } });
+    SparksEffect* sparks = pool.create<SparksEffect>(keyboard);
+    std::vector<Color> frame(keys.size());
+    KeySet touched(keys.size());
+
+    // Keep the population topped up to `particleCount`, with bursts of 64 from
+    // different keys, and time the move, age, compact and splat of every spark.
+    const Result result = measure([&](int i) {
+        for (int burst = 0; sparks->getParticleCount() + 64 <= particleCount; ++burst) {
+            sparks->emit(keys[((i + burst) * 41) % keys.size()], colorFor(i + burst), 64, 240);
+        }
+        sparks->update();
+        touched.clear();
+        for (uint16_t k = 0; k < keys.size(); ++k) {
+            frame[k] = Color(0, 0, 0);
+        }
+        sparks->composite(keys, frame, touched);
+        g_sink = g_sink + static_cast<uint32_t>(touched.size());
+    });
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "SparksEffect (%4zu sparks)", particleCount);
+    report(name, "frame", result, keys.size());
+    pool.destroy(sparks);
+}
+
+void benchSpectrum(const Keyboard& keyboard) {
+    const auto keys = keyboard.getKeys();
+    constexpr uint32_t sampleRate = 44100;
+    constexpr size_t samplesPerFrame = sampleRate / 60;
+    PcmRing ring(sampleRate);
+    EffectPool pool({ { EffectPool::slotSizeFor<SpectrumEffect>(keyboard), 1 } });
+    SpectrumEffect* spectrum = pool.create<SpectrumEffect>(keyboard);
+    spectrum->attach(ring, colorFor(0));
+    std::vector<Color> frame(keys.size());
+    KeySet touched(keys.size());
+
+    // A frame's worth of a chord, pushed as the reader would, then read,
+    // transformed and drawn: the whole audio path of one frame.
+    std::vector<int16_t> audio(samplesPerFrame * 64);
+    for (size_t n = 0; n < audio.size(); ++n) {
+        const double t = static_cast<double>(n) / sampleRate;
+        audio[n] = static_cast<int16_t>(6000.0 * (std::sin(6.2831853 * 110.0 * t) + std::sin(6.2831853 * 880.0 * t) + std::sin(6.2831853 * 5000.0 * t)));
+    }
+    const Result result = measure([&](int i) {
+        ring.push(&audio[(static_cast<size_t>(i) % 64) * samplesPerFrame], samplesPerFrame);
+        spectrum->update();
+        touched.clear();
+        for (uint16_t k = 0; k < keys.size(); ++k) {
+            frame[k] = Color(0, 0, 0);
+        }
+        spectrum->composite(keys, frame, touched);
+        g_sink = g_sink + static_cast<uint32_t>(touched.size());
+    });
+    report("SpectrumEffect (FFT 512)", "frame", result, keys.size());
+    pool.destroy(spectrum);
+}
+
+void benchLayeredManager(Keyboard& keyboard, int rippleCount) {
+    const auto keys = keyboard.getKeys();
+    LightingManager manager(&keyboard, static_cast<size_t>(rippleCount) * 2 + 1);
+
+    // A full-keyboard backlight on layer 0, with sparse key flashes blended
+    // over it on layer 1: a delay longer than the step never spreads, so each
+    // ripple lights just its own key.
+    manager.addSolidColorEffect(Color(0, 0, 96));
+    manager.setLayerBlendMode(1, BlendMode::Max);
+    constexpr int flashLifetime = 3 * STEP_DURATION;
+    const int spawnInterval = rippleCount > 0 ? std::max(1, flashLifetime / rippleCount) : 0;
+    const Result result = measure([&](int frame) {
+        if (rippleCount > 0 && frame % spawnInterval == 0) {
+            const int n = frame / spawnInterval;
+            manager.addRippleEffect(keys[(n * 41) % keys.size()], colorFor(n), STEP_DURATION, STEP_DURATION, flashLifetime, 0, 1);
+        }
+        manager.update();
+        g_sink = g_sink + static_cast<uint32_t>(manager.getDirtyKeys().size());
+    });
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "Layered update (base + %2d)", rippleCount);
+    report(name, "frame", result, keys.size());
+}
+
+void benchEffectPool(const Keyboard& keyboard) {
+    const Key& start = *keyboard.findKeyById(KeyCode::G);
+    EffectPool pool({ { EffectPool::slotSizeFor<RippleEffect>(keyboard), 20 } });
+
+    const Result result = measure([&](int i) {
+        IEffect* effect = pool.create<RippleEffect>(keyboard, start, colorFor(i & 7), STEP_DURATION, PROPAGATION_DELAY, MAX_LIFETIME);
+        pool.destroy(effect);
+    });
+    report("EffectPool create+destroy", "pair", result, 0);
+}
+
+void benchLedEncoder(const Keyboard& keyboard, const char* name, const WireFormat& format) {
+    const size_t keyCount = keyboard.getKeys().size();
+    LedEncoder encoder(format, keyCount);
+
+    // A full frame of distinct colors, so no channel is constant.
+    std::vector<Color> frame(keyCount);
+    for (size_t i = 0; i < keyCount; ++i) {
+        frame[i] = colorFor(static_cast<int>(i));
+    }
+
+    const Result result = measure([&](int) {
+        encoder.encodeAll(frame);
+        g_sink = g_sink + encoder.data()[encoder.pixelOffset(0)];
+    });
+    report(name, "frame", result, keyCount);
+}
+
+void benchTopologyFromPoints(const Keyboard& keyboard) {
+    // The Keyboard itself is a view of constant tables and costs nothing to
+    // construct, so time the runtime build of the same layout instead.
+    std::vector<Position> points;
+    points.reserve(keyboard.getKeys().size());
+    for (const Key& key : keyboard.getKeys()) {
+        points.push_back(key.getPosition());
+    }
+
+    const Result result = measure([&](int) {
+        const Topology topology = Topology::fromPoints(points);
+        g_sink = g_sink + static_cast<uint32_t>(topology.getKeys().size());
+    });
+    report("Topology::fromPoints (keyboard)", "build", result, points.size());
+}
+
+} // namespace
+
+// --- Allocation Counting ---
+// Replacing the global allocation functions lets the benchmark count every
+// heap allocation the engine makes, without any instrumentation in the engine.
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+int main() {
+    Keyboard keyboard;
+    std::printf("Core benchmark: %zu keys, %d iterations per test\n\n", keyboard.getKeys().size(), ITERATIONS);
+
+    benchRippleEffect(keyboard);
+    for (int effectCount : { 1, 5, 20 }) {
+        benchLightingManager(keyboard, effectCount);
+    }
+    for (int rippleCount : { 1, 20, 240 }) {
+        benchRippleField(keyboard, rippleCount);
+    }
+    for (size_t particleCount : { size_t{ 256 }, MAX_PARTICLES }) {
+        benchSparks(keyboard, particleCount);
+    }
+    benchSpectrum(keyboard);
+    for (int rippleCount : { 0, 4, 12 }) {
+        benchLayeredManager(keyboard, rippleCount);
+    }
+    benchLedEncoder(keyboard, "LedEncoder::encodeAll (WS2812)", WireFormat::ws2812());
+    benchLedEncoder(keyboard, "LedEncoder::encodeAll (APA102)", WireFormat::apa102());
+    benchLedEncoder(keyboard, "LedEncoder::encodeAll (RGB565)", WireFormat::rgb565());
+    benchEffectPool(keyboard);
+    benchTopologyFromPoints(keyboard);
+    return 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "Core/Keyboard/Key.h"
 #include "Core/Util/Color.h"
+#include "Core/Util/KeySet.h"
+#include "Core/Util/Span.h"
 /**
  * @class IEffect
  * @brief An interface defining the contract for all lighting effects.
@@ -30,9 +32,50 @@ public:
      */
     virtual Color getColorForKey(const Key& key) const = 0;
 
+    /**
+     * @brief Composites this effect's contribution straight into a frame buffer.
+     *
+     * This is the batched rendering entry point used by the LightingManager. The
+     * effect additively blends its color into `frame[i]` for every key it lights
+     * and records `i` in `touched`. Keys the effect does not light must be left
+     * alone, so the caller never needs to visit them.
+     *
+     * The default implementation adapts getColorForKey(): it visits every key and
+     * skips black results. Effects that know which keys they light should override
+     * it to avoid the per-key virtual call.
+     *
+     * @param keys All keys of the keyboard, indexed by Key::getIndex().
+     * @param frame The frame buffer to blend into. Same size and order as `keys`.
+     * @param touched Receives the index of every key this effect lit.
+     */
+    virtual void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const {
+        const Color black(0, 0, 0);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const Color color = getColorForKey(keys[i]);
+            if (color != black) {
+                frame[i] = frame[i].add(color);
+                touched.insert(i);
+            }
+        }
+    }
+
     /**
      * @brief Checks if the effect has completed its lifecycle.
      * @return true if the effect is finished and can be removed, false otherwise.
      */
     virtual bool isFinished() const = 0;
+
+    /**
+     * @brief Gets how bright the effect currently is, i.e. the brightness of the
+     *        brightest key it lights.
+     *
+     * The LightingManager uses this to pick a victim when it has to evict an
+     * effect to make room for a new one. Called only then, never per frame.
+     * The default reports full brightness until the effect finishes.
+     *
+     * @return The intensity (0-255), 0 if the effect lights nothing.
+     */
+    virtual uint8_t getIntensity() const {
+        return isFinished() ? 0 : 255;
+    }
 };
\ No newline at end of file
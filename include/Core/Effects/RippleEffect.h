@@ -1,45 +1,91 @@
 #pragma once
 #include "Core/Effects/IEffect.h"
-#include <unordered_map> // Use the faster hash table instead of std::map
+#include "Core/Keyboard/Topology.h"
+#include "Core/Util/ColorTables.h"
+#include "Core/Util/KeyBitset.h"
+#include "Core/Util/StateBuffer.h"
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @class RippleEffect
  * @brief A cellular automata-based ripple with controllable step duration.
  *
- * This effect creates a propagating wave of light. The duration of each
- * brightness step (Ignited, Fading_High, Fading_Low) is configurable,
- * allowing for effects that can be fast with a long, slow fade, or vice-versa.
- * 
+ * This effect creates a propagating wave of light. A key lights up at full
+ * brightness when the wave reaches it and then fades out smoothly over
+ * FADE_STEPS steps of `stepDuration` frames; while it is in its first step it
+ * is the crest of the wave and ignites its neighbors.
+ *
+ * The lit keys are stored as one KeyBitset, plus an array of per-key fade
+ * phases indexed by Key::getIndex(), both sized for the topology (see
+ * stateSize()). A phase is a Q8.8 fixed-point position in the fade: it
+ * advances by a constant computed once per effect, and its high byte indexes
+ * the ColorTables::FADE_OUT curve, so a key's color is one table read and one
+ * Color::scale(), with no division and no branch on its fade level.
+ * Propagation collects the neighborhood of every crest key into a single
+ * "spread" set and removes the keys that are already lit. On a keyboard (any
+ * topology with neighbor masks) a neighborhood is one OR of a precomputed
+ * mask, so a step is a few OR/AND-NOT word operations; on larger topologies it
+ * costs one bit set per neighbor from the CSR list. It runs on any Topology,
+ * from a keyboard to an LED wall. A steady-state update performs no heap
+ * allocation and no hashing.
+ *
  * @author Michele Bisignano
  */
 class RippleEffect : public IEffect {
-private:
+public:
+    // A lit key fades out over this many steps of `stepDuration` frames.
+    static constexpr int FADE_STEPS = 3;
+
+    // The longest step whose whole fade still fits a 16-bit phase.
+    static constexpr int MAX_STEP_DURATION = 0xFFFF / FADE_STEPS;
+
     /**
-     * @enum State
-     * @brief Defines the discrete brightness levels for a key in the effect.
+     * @brief Clamps a step duration to 1..MAX_STEP_DURATION frames.
      */
-    enum class State {Ignited, Fading_High, Fading_Low };
+    static constexpr int clampStepDuration(int stepDuration) {
+        return stepDuration < 1 ? 1 : (stepDuration > MAX_STEP_DURATION ? MAX_STEP_DURATION : stepDuration);
+    }
 
+    /**
+     * @brief Gets how far a key's Q8.8 fade phase advances per frame.
+     *
+     * The one division of the fade, done when an effect is created.
+     * @param stepDuration A step duration, already clamped (see clampStepDuration()).
+     */
+    static constexpr uint16_t fadePhaseStep(int stepDuration) {
+        return static_cast<uint16_t>(0x10000 / (FADE_STEPS * stepDuration));
+    }
 
     /**
-     * @struct KeyState
-     * @brief Holds the state for a single key within this effect's animation.
+     * @brief Gets the color of a key at a given Q8.8 fade phase: one table read and one multiply.
+     *
+     * Color::scale() divides by 256, so the table's full level of 255 would
+     * still dim the color slightly; a key at the start of its fade shows the
+     * color unchanged instead.
      */
-    struct KeyState {
-        State state;
-        int framesInState = 0; // Counter for how many frames the key has been in its current state.
-    };
+    static constexpr Color fadeColor(const Color& color, uint16_t phase) {
+        const uint8_t level = ColorTables::FADE_OUT[phase >> 8];
+        return level == 255 ? color : color.scale(level);
+    }
+
+    /**
+     * @brief Gets the bytes of per-key state a ripple needs on a topology.
+     */
+    static size_t stateSize(const Topology& topology);
 
-public:
     /**
-     * @brief Constructs a new RippleEffect.
+     * @brief Constructs a new RippleEffect. Usually created through an EffectPool, which provides `state`.
+     * @param topology The keyboard (or any topology) the ripple runs on. Must outlive the effect.
+     * @param state stateSize(topology) bytes for the per-key state. Must outlive the effect.
      * @param startKey The key where the ripple originates.
      * @param color The color of the ripple.
-     * @param stepDuration The number of frames each key will spend in each brightness state (your 'X').
+     * @param stepDuration The number of frames in each of the FADE_STEPS steps of a key's fade (your 'X').
      * @param propagationDelay The number of frames to wait before the wave expands to the next ring of keys.
+     * @param maxLifetime The total number of frames the effect lives for.
      */
-    RippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime);
-    
+    RippleEffect(const Topology& topology, StateBuffer state, const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime);
+
     /**
      * @brief Updates the state of the ripple for the next frame.
      */
@@ -50,18 +96,41 @@ public:
      */
     Color getColorForKey(const Key& key) const override;
 
+    /**
+     * @brief Blends the ripple into the frame, visiting only the keys it lights.
+     */
+    void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const override;
+
     /**
      * @brief Checks if the effect has completed.
      */
     bool isFinished() const override;
 
+    /**
+     * @brief Gets the brightness of the brightest key the ripple currently lights.
+     */
+    uint8_t getIntensity() const override;
+
 private:
-    // Use std::unordered_map for fast, O(1) average lookup time while maintaining decoupling.
-    std::unordered_map<const Key*, KeyState> activeKeys_;
+    const Topology* topology_;
+
+    // The keys that are currently part of the ripple.
+    KeyBitset lit_;
+
+    // The keys the crest reaches this frame; scratch space for update().
+    KeyBitset spread_;
+
+    // How far each lit key is through its fade, in Q8.8 fixed point (the high
+    // byte indexes ColorTables::FADE_OUT). Always 0 for keys that are not lit.
+    Span<uint16_t> fadePhase_;
 
     const Color color_;
-    const int stepDuration_;
-    const int propagationDelay_;
+    const uint16_t phaseStep_;
+    // The phases, all multiples of phaseStep_, at which a key ignites its
+    // neighbors (from spreadFrom_ up to, not including, spreadUntil_) and goes dark.
+    const uint32_t spreadFrom_;
+    const uint32_t spreadUntil_;
+    const uint32_t fadeEnd_;
     int framesLived_ = 0;
     const int maxLifetime_;
-};
\ No newline at end of file
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include "Core/Effects/IEffect.h"
+#include "Core/Effects/RippleEffect.h"
+#include "Core/Keyboard/Topology.h"
+#include "Core/Util/KeyBitset.h"
+#include "Core/Util/StateBuffer.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class RippleFieldEffect
+ * @brief Any number of ripples, advanced together in one pass over the lit keys.
+ *
+ * Instead of one effect per key press, the field keeps the wave state on the
+ * keys themselves: each key carries the newest wave that reached it, with that
+ * wave's color and timing, and its position in the fade. addSource() lights a
+ * key with a new wave in O(1) and never fails, so presses are never dropped,
+ * and update() walks each lit key and its neighbors once, however many waves
+ * are running. The cost of a frame is bounded by the number of keys. The
+ * per-key state is sized for the topology (see stateSize()).
+ *
+ * Every wave spreads and fades exactly like a RippleEffect with the same
+ * parameters (see RippleEffect::fadeColor()), and goes dark when its
+ * `maxLifetime` is over. Waves are numbered in the order they were added; a
+ * key only takes a wave that is newer than the one it already carries, which
+ * keeps fronts from bouncing back and forth. Where a newer front crosses an
+ * older one, the older wave keeps fading on the key underneath the newer one
+ * and the two are blended additively, so overlapping fronts mix instead of
+ * cutting each other off. When two fronts reach a key in the same frame, the
+ * newer one carries on.
+ *
+ * The field reports itself finished when no key is lit, so a LightingManager
+ * can retire it while the keyboard is idle.
+ *
+ * @author Michele Bisignano
+ */
+class RippleFieldEffect : public IEffect {
+public:
+    /**
+     * @brief Gets the bytes of per-key state a field needs on a topology.
+     */
+    static size_t stateSize(const Topology& topology);
+
+    /**
+     * @brief Constructs an empty field. Nothing is lit until addSource().
+     *
+     * Usually created through an EffectPool, which provides `state`.
+     * @param topology The keyboard (or any topology) the ripples run on. Must outlive the effect.
+     * @param state stateSize(topology) bytes for the per-key state. Must outlive the effect.
+     */
+    RippleFieldEffect(const Topology& topology, StateBuffer state);
+
+    /**
+     * @brief Starts a new ripple. O(1), and never fails.
+     *
+     * Takes the same parameters as a RippleEffect and produces the same wave.
+     * @param startKey The key where the ripple originates.
+     * @param color The color of the ripple.
+     * @param stepDuration The number of frames in each of the RippleEffect::FADE_STEPS steps of a key's fade.
+     * @param propagationDelay The number of frames to wait before the wave expands to the next ring of keys.
+     * @param maxLifetime The total number of frames the ripple lives for.
+     */
+    void addSource(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime);
+
+    /**
+     * @brief Advances every wave by one frame.
+     */
+    void update() override;
+
+    /**
+     * @brief Gets the blended color of every wave on a key.
+     */
+    Color getColorForKey(const Key& key) const override;
+
+    /**
+     * @brief Blends every lit key into the frame, visiting only the lit keys.
+     */
+    void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const override;
+
+    /**
+     * @brief Checks whether no key is lit.
+     */
+    bool isFinished() const override;
+
+    /**
+     * @brief Gets the brightness of the brightest key the field currently lights.
+     */
+    uint8_t getIntensity() const override;
+
+private:
+    /**
+     * @struct Wave
+     * @brief One ripple's state on one key.
+     */
+    struct Wave {
+        Color color;
+        uint32_t generation = 0; // The order the wave was added in; 0 for none.
+        uint32_t endFrame = 0;   // The frame the wave goes dark at.
+        uint16_t phase = 0;      // Q8.8 position in the fade, as in RippleEffect.
+        uint16_t phaseStep = 0;
+        uint16_t spreadFrom = 0;  // The crest phases, as in RippleEffect.
+        uint16_t spreadUntil = 0;
+    };
+
+    /**
+     * @brief Gets the color a wave shows on a key.
+     */
+    static Color colorOf(const Wave& wave) {
+        return RippleEffect::fadeColor(wave.color, wave.phase);
+    }
+
+    /**
+     * @brief Checks whether a wave is over at the current frame.
+     */
+    bool hasEnded(const Wave& wave) const;
+
+    /**
+     * @brief Puts a wave at the start of its fade on a key, keeping the key's
+     *        current wave underneath if it is brighter than the one already there.
+     */
+    void ignite(size_t index, const Wave& wave);
+
+    /**
+     * @brief Advances the waves of one layer (`carried_` or `underneath_`) and drops the ones that are over.
+     */
+    void advance(Span<Wave> waves, KeyBitset& lit);
+
+    const Topology* topology_;
+
+    // The newest wave on each key; it spreads to the neighbors. The generation
+    // is kept after the wave fades, so an old wave can never relight the key.
+    Span<Wave> carried_;
+    KeyBitset carriedLit_;
+
+    // An older wave still fading under the carried one. It never spreads.
+    Span<Wave> underneath_;
+    KeyBitset underneathLit_;
+
+    // The waves reaching each key this frame; scratch space for update().
+    Span<Wave> arriving_;
+    KeyBitset arrivals_;
+
+    uint32_t frame_ = 0;
+    uint32_t nextGeneration_ = 1;
+};
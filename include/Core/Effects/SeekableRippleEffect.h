@@ -0,0 +1,110 @@
+#pragma once
+#include "Core/Effects/IEffect.h"
+#include "Core/Effects/RippleEffect.h"
+#include "Core/Keyboard/Topology.h"
+#include <cstdint>
+
+/**
+ * @class SeekableRippleEffect
+ * @brief A stateless ripple whose color at any frame is computed in closed form.
+ *
+ * This effect produces the same wave as RippleEffect, but without simulating
+ * it frame by frame. A key at hop distance d from the origin is ignited at
+ * frame d * (propagationDelay + 1) and then fades out over
+ * RippleEffect::FADE_STEPS * stepDuration frames, along the same
+ * ColorTables::FADE_OUT curve. Since the hop distance is read from the
+ * Topology's pre-calculated table, the color of any key at any frame is two
+ * table reads, a multiply and a few comparisons. The topology must have a
+ * hop-distance table (see Topology::hasHopDistances()).
+ *
+ * As a consequence update() is O(1), and the effect can be evaluated at an
+ * arbitrary timestamp: frames can be skipped, rewound with seek(), or rendered
+ * in parallel from several threads.
+ *
+ * @author Michele Bisignano
+ */
+class SeekableRippleEffect : public IEffect {
+public:
+    /**
+     * @brief Constructs a new SeekableRippleEffect.
+     * @param topology The keyboard (or any topology with hop distances) the ripple runs on.
+     *        Must outlive the effect.
+     * @param startKey The key where the ripple originates.
+     * @param color The color of the ripple.
+     * @param stepDuration The number of frames in each of the RippleEffect::FADE_STEPS steps of a key's fade.
+     * @param propagationDelay The number of frames to wait before the wave expands to the next ring of keys.
+     * @param maxLifetime The total number of frames the effect lives for.
+     */
+    SeekableRippleEffect(const Topology& topology, const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime);
+
+    /**
+     * @brief Advances the effect by one frame. Only increments the frame counter.
+     */
+    void update() override;
+
+    /**
+     * @brief Gets the color for a specific key at the current frame.
+     */
+    Color getColorForKey(const Key& key) const override;
+
+    /**
+     * @brief Blends the ripple into the frame by reading the origin's hop-distance row.
+     */
+    void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const override;
+
+    /**
+     * @brief Checks if the effect has completed.
+     */
+    bool isFinished() const override;
+
+    /**
+     * @brief Gets the brightness of the brightest key the ripple currently lights.
+     */
+    uint8_t getIntensity() const override;
+
+    /**
+     * @brief Gets the color for a specific key at an arbitrary frame.
+     * @param key The key for which to calculate the color.
+     * @param frame The frame to evaluate, counted from the creation of the effect.
+     * @return The color of the key at that frame, black if it is not lit.
+     */
+    Color getColorAt(const Key& key, int frame) const;
+
+    /**
+     * @brief Moves the effect to an arbitrary frame, forwards or backwards.
+     * @param frame The frame to jump to, counted from the creation of the effect.
+     */
+    void seek(int frame);
+
+    /**
+     * @brief Gets the frame the effect is currently at.
+     */
+    int getFrame() const;
+
+private:
+    /**
+     * @brief Computes the color of a key given its hop distance from the origin.
+     */
+    Color colorForHops(uint8_t hops, int frame) const;
+
+    /**
+     * @brief Computes the color of a key that has been lit for `age` frames.
+     */
+    Color colorForAge(int age) const;
+
+    const Topology* topology_;
+    const size_t startIndex_;
+
+    const Color color_;
+    const int stepDuration_;
+    // How far a key's Q8.8 fade phase advances per frame (see RippleEffect::fadePhaseStep()).
+    const uint16_t phaseStep_;
+    // Frames between the ignition of one ring of keys and the next.
+    const int ringInterval_;
+    // Whether the wave ever leaves the origin key.
+    const bool propagates_;
+    // The hop distance of the farthest key the wave reaches.
+    uint8_t farthestHops_ = 0;
+    int framesLived_ = 0;
+    const int maxLifetime_;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include "Core/Effects/IEffect.h"
+#include "Core/Keyboard/Topology.h"
+
+/**
+ * @class SolidColorEffect
+ * @brief Lights every key of the topology with one color.
+ *
+ * Meant as a base layer under other effects (see LightingManager::setLayerBlendMode()):
+ * a backlight that ripples are blended over, or a Multiply layer that tints them.
+ * It lives for `maxLifetime` frames, or until its layer is cleared when
+ * `maxLifetime` is 0 or less.
+ *
+ * @author Michele Bisignano
+ */
+class SolidColorEffect : public IEffect {
+public:
+    /**
+     * @brief Constructs a new SolidColorEffect.
+     * @param topology The keyboard (or any topology) to light. Every key it has is lit.
+     * @param color The color of every key. Its alpha is used by BlendMode::AlphaOver layers.
+     * @param maxLifetime The total number of frames the effect lives for; 0 or less for no limit.
+     */
+    SolidColorEffect(const Topology& topology, const Color& color, int maxLifetime);
+
+    void update() override;
+    Color getColorForKey(const Key& key) const override;
+
+    /**
+     * @brief Blends the color into every key, with no per-key virtual call.
+     */
+    void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const override;
+
+    bool isFinished() const override;
+    uint8_t getIntensity() const override;
+
+private:
+    const Color color_;
+    const int maxLifetime_;
+    int framesLived_ = 0;
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include "Core/Effects/IEffect.h"
+#include "Core/Keyboard/Topology.h"
+#include "Core/Util/Random.h"
+#include "Core/Util/StateBuffer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The most sparks alive at once. All of their state is reserved up front, 24
+// bytes each, so memory-tight builds can lower it with -DRIPPLEFX_MAX_PARTICLES=<n>.
+#if defined(RIPPLEFX_MAX_PARTICLES)
+constexpr size_t MAX_PARTICLES = RIPPLEFX_MAX_PARTICLES;
+#else
+constexpr size_t MAX_PARTICLES = 2048;
+#endif
+
+/**
+ * @class SparksEffect
+ * @brief Sparks that fly out of pressed keys, slow down and fade.
+ *
+ * The particles live in fixed structure-of-arrays buffers: one array each for
+ * x, y, the velocity components, the color and the fade phase, with the live
+ * particles packed at the front. update() is one straight pass of float
+ * arithmetic over the motion arrays, which the compiler vectorizes, followed by
+ * one pass that ages the particles and compacts the survivors in place.
+ * Nothing is allocated after construction; emit() only fills free slots.
+ *
+ * Particles move in the key plane, in the units of Key::getPosition(). To
+ * light keys, the constructor lays a uniform bucket grid over the topology and
+ * stores, for each cell, the nearest key within SPLAT_RADIUS (or none). A
+ * particle is splatted by turning its position into a cell index and reading
+ * one table entry, with no search. Particles that leave the grid are dropped.
+ * The grid is the effect's only per-key state: GRID_CELLS_PER_KEY cells per
+ * key of the topology (see stateSize()).
+ *
+ * The fade follows ColorTables::FADE_OUT, like the ripples.
+ *
+ * @author Michele Bisignano
+ */
+class SparksEffect : public IEffect {
+public:
+    // The most grid cells per key. Denser layouts get smaller cells, up to this budget.
+    static constexpr size_t GRID_CELLS_PER_KEY = 8;
+
+    // How far from a key's center a spark still lights it, in key units.
+    static constexpr float SPLAT_RADIUS = 0.75f;
+
+    // The fraction of its speed a spark keeps from one frame to the next.
+    static constexpr float DRAG = 0.94f;
+
+    /**
+     * @brief Gets the bytes of bucket grid the effect needs on a topology.
+     */
+    static size_t stateSize(const Topology& topology);
+
+    /**
+     * @brief Constructs an effect with no sparks, and builds its bucket grid.
+     *
+     * Usually created through an EffectPool, which provides `state`.
+     * @param topology The keyboard (or any topology) to light. Must outlive the effect.
+     * @param state stateSize(topology) bytes for the bucket grid. Must outlive the effect.
+     * @param seed The seed of the generator that scatters the sparks.
+     */
+    SparksEffect(const Topology& topology, StateBuffer state, uint32_t seed = 1);
+
+    /**
+     * @brief Sends a burst of sparks out of a key, in random directions and at random speeds.
+     * @param origin The key the sparks come from.
+     * @param color The color of the sparks.
+     * @param count How many sparks to emit. Only as many as there are free slots are emitted.
+     * @param lifetime How many frames the sparks take to fade out, up to half as long again for some.
+     * @return The number of sparks emitted.
+     */
+    size_t emit(const Key& origin, const Color& color, size_t count, int lifetime);
+
+    /**
+     * @brief Gets the number of live sparks.
+     */
+    size_t getParticleCount() const { return count_; }
+
+    /**
+     * @brief Moves and ages every spark, dropping the ones that faded out or left the grid.
+     */
+    void update() override;
+
+    /**
+     * @brief Gets the sum of the sparks that land on a key. Visits every spark; not for the frame loop.
+     */
+    Color getColorForKey(const Key& key) const override;
+
+    /**
+     * @brief Splats every spark onto its key, one grid lookup per spark.
+     */
+    void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const override;
+
+    /**
+     * @brief Checks whether no spark is alive.
+     */
+    bool isFinished() const override;
+
+    /**
+     * @brief Gets the brightness of the brightest spark.
+     */
+    uint8_t getIntensity() const override;
+
+private:
+    // Marks a grid cell with no key within SPLAT_RADIUS.
+    static constexpr uint16_t NO_KEY = 0xFFFF;
+
+    // The number of directions sparks are emitted in.
+    static constexpr size_t DIRECTION_COUNT = 32;
+
+    /**
+     * @brief Gets the key a particle at grid coordinates (x, y) lights, or NO_KEY.
+     */
+    uint16_t keyAt(float x, float y) const;
+
+    /**
+     * @brief Gets the color a spark shows at its current fade phase.
+     */
+    Color colorOf(size_t particle) const;
+
+    void buildGrid();
+
+    const Topology* topology_;
+    Random rng_;
+
+    // Particle state, one array per field; particle i is element i of each.
+    // Positions are in grid coordinates: key units, relative to the grid origin.
+    std::array<float, MAX_PARTICLES> x_;
+    std::array<float, MAX_PARTICLES> y_;
+    std::array<float, MAX_PARTICLES> vx_;
+    std::array<float, MAX_PARTICLES> vy_;
+    std::array<Color, MAX_PARTICLES> color_;
+    std::array<uint16_t, MAX_PARTICLES> phase_; // Q8.8 position in the fade, as in RippleEffect.
+    std::array<uint16_t, MAX_PARTICLES> phaseStep_;
+    size_t count_ = 0;
+
+    // The bucket grid: cell (column, row) is keyForCell_[row * columns_ + column].
+    Span<uint16_t> keyForCell_;
+    float originX_ = 0.0f;
+    float originY_ = 0.0f;
+    float cellSize_ = 1.0f;
+    float inverseCellSize_ = 1.0f;
+    size_t columns_ = 0;
+    size_t rows_ = 0;
+    float width_ = 0.0f;
+    float height_ = 0.0f;
+
+    // Unit vectors of the emission directions.
+    std::array<float, DIRECTION_COUNT> directionX_;
+    std::array<float, DIRECTION_COUNT> directionY_;
+};
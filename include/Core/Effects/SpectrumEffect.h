@@ -0,0 +1,138 @@
+#pragma once
+#include "Core/Effects/IEffect.h"
+#include "Core/Input/PcmRing.h"
+#include "Core/Keyboard/Topology.h"
+#include "Core/Util/RealFft.h"
+#include "Core/Util/StateBuffer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class SpectrumEffect
+ * @brief A spectrum analyzer: the keyboard's columns become the bars of a live audio spectrum.
+ *
+ * Once per frame, update() drains every sample that arrived in its PcmRing
+ * since the previous frame into a history of the newest FFT_SIZE samples,
+ * runs one RealFft over them and sets each bar from the power of its band.
+ * The analysis always ends at the newest sample, so the light lags the audio
+ * by less than one frame plus the reader's block, however the two clocks
+ * drift. The transform works in fixed arrays: nothing is allocated.
+ *
+ * The constructor sorts the keys into columns by Key::getPosition() (one
+ * column per key unit across, at most MAX_COLUMNS) and gives each column a
+ * band of the spectrum, low frequencies on the left, spaced logarithmically.
+ * A bar rises instantly and falls back smoothly, and lights its column from
+ * the bottom row up; the key at the top of the bar is lit in proportion.
+ *
+ * The effect is finished once its stream has ended and every bar has fallen.
+ *
+ * @author Michele Bisignano
+ */
+class SpectrumEffect : public IEffect {
+public:
+    // Samples per transform: 11.6 ms of audio at 44.1 kHz, under one frame at 60 FPS.
+    static constexpr size_t FFT_SIZE = 512;
+
+    // The most bars. Wider layouts get columns more than one key unit wide.
+    static constexpr size_t MAX_COLUMNS = 32;
+
+    // The frequency range spread across the bars, in Hz.
+    static constexpr float MIN_FREQUENCY = 40.0f;
+    static constexpr float MAX_FREQUENCY = 16000.0f;
+
+    // The band power, relative to a full-scale sine, at which a bar is empty.
+    static constexpr float FLOOR_DB = -60.0f;
+
+    // The fraction of its height a bar keeps from one frame to the next while it falls.
+    static constexpr float FALL = 0.85f;
+
+    /**
+     * @brief Gets the bytes of per-key state (each key's column and row) the effect needs on a topology.
+     */
+    static size_t stateSize(const Topology& topology);
+
+    /**
+     * @brief Constructs an effect with no stream, and sorts the keys into columns.
+     *
+     * Usually created through an EffectPool, which provides `state`.
+     * @param topology The keyboard (or any topology) to light. Must outlive the effect.
+     * @param state stateSize(topology) bytes for the per-key state. Must outlive the effect.
+     */
+    SpectrumEffect(const Topology& topology, StateBuffer state);
+
+    /**
+     * @brief Starts (or switches to) a stream, and fits the bands to its sample rate.
+     * @param source The stream to analyze. Must outlive the effect or the next attach().
+     * @param color The color of the bars.
+     */
+    void attach(PcmRing& source, const Color& color);
+
+    /**
+     * @brief Gets the number of bars.
+     */
+    size_t getColumnCount() const { return columnCount_; }
+
+    /**
+     * @brief Gets the height of a bar, from 0 (empty) to 1 (full).
+     */
+    float getLevel(size_t column) const { return level_[column]; }
+
+    /**
+     * @brief Reads the new samples and, if there are any, analyzes the newest FFT_SIZE of them.
+     */
+    void update() override;
+
+    Color getColorForKey(const Key& key) const override;
+
+    /**
+     * @brief Blends every key under the top of its bar into the frame.
+     */
+    void composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const override;
+
+    /**
+     * @brief Checks whether the stream has ended and every bar has fallen.
+     */
+    bool isFinished() const override;
+
+    uint8_t getIntensity() const override;
+
+private:
+    using Fft = RealFft<FFT_SIZE>;
+
+    /**
+     * @brief Reads every sample available into the history.
+     * @return The number of samples read.
+     */
+    size_t drain();
+
+    /**
+     * @brief Gets the color of a key: the bar color, scaled by how much of the key the bar covers.
+     */
+    Color colorOf(size_t index) const;
+
+    const Topology* topology_;
+    PcmRing* source_ = nullptr;
+    Color color_;
+    Fft fft_;
+
+    // The newest FFT_SIZE samples, a ring with the oldest at historyHead_.
+    std::array<int16_t, FFT_SIZE> history_{};
+    size_t historyHead_ = 0;
+
+    // Scratch space for update(): the history in order, and its spectrum.
+    std::array<float, FFT_SIZE> samples_{};
+    std::array<float, Fft::BINS> power_{};
+
+    // Column c covers the bins [bandStart_[c], bandStart_[c + 1]).
+    std::array<uint16_t, MAX_COLUMNS + 1> bandStart_{};
+    std::array<float, MAX_COLUMNS> level_{};
+    size_t columnCount_ = 0;
+    bool dark_ = true;
+
+    // Per key: its column, and the bar height at which it starts to light. It
+    // is fully lit one row higher, rowHeight_ in bar units.
+    Span<uint8_t> columnOf_;
+    Span<float> bottomOf_;
+    float rowHeight_ = 1.0f;
+};
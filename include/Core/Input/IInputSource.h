@@ -0,0 +1,48 @@
+// include/Input/IInputSource.h
+
+#pragma once
+#include "Core/Input/KeyEvent.h"
+#include <cstdint>
+
+/**
+ * @class IInputSource
+ * @brief An interface for anything that produces key press and release events.
+ *
+ * Sources report every transition with its own timestamp, so a press shorter
+ * than a frame still starts a ripple, and the ripple is timed by when the key
+ * was actually pressed rather than by when the engine happened to look.
+ *
+ * @author Michele Bisignano
+ */
+class IInputSource {
+public:
+    /**
+     * @brief Virtual destructor. Essential for any class intended for polymorphic deletion.
+     */
+    virtual ~IInputSource() = default;
+
+    /**
+     * @brief Pushes every event that happened since the previous call, oldest first.
+     *
+     * Never blocks. If the queue fills up, the events that did not fit are kept
+     * and delivered by a later call.
+     * @param events The queue to push into. The caller is its only producer.
+     * @param nowMs The current time, in milliseconds. Sources that cannot timestamp
+     *        events themselves stamp them with it.
+     */
+    virtual void pollEvents(KeyEventQueue& events, uint32_t nowMs) = 0;
+
+    /**
+     * @brief Blocks until the source may have events, or until the timeout expires.
+     *
+     * Lets an idle engine sleep until there is input, instead of polling. The
+     * default does not block and returns false: sources that can only be polled
+     * keep it, and the caller sleeps and polls them at a slow rate instead.
+     * @param timeoutMs The longest time to block, in milliseconds.
+     * @return true if the source supports waiting (whether or not events arrived).
+     */
+    virtual bool waitForEvents(uint32_t timeoutMs) {
+        (void)timeoutMs;
+        return false;
+    }
+};
@@ -0,0 +1,36 @@
+// include/Input/KeyEvent.h
+
+#pragma once
+#include "Core/Util/SpscQueue.h"
+#include <cstdint>
+
+/**
+ * @brief Whether a key went down or up.
+ */
+enum class KeyAction : uint8_t {
+    Press,
+    Release
+};
+
+/**
+ * @struct KeyEvent
+ * @brief A single key transition, as reported by an input source.
+ *
+ * Events are 8 bytes and trivially copyable, so they can be passed between
+ * threads through a lock-free ring without any allocation.
+ *
+ * @author Michele Bisignano
+ */
+struct KeyEvent {
+    uint32_t timestampMs = 0; // When the transition happened, on the source's millisecond clock.
+    uint16_t keyIndex = 0; // The key's Key::getIndex().
+    KeyAction action = KeyAction::Press;
+};
+
+/**
+ * @brief The queue that carries key events from an input source to the engine.
+ *
+ * 256 events hold far more than anyone can type in one frame; a source that
+ * finds it full keeps its remaining events and delivers them on the next poll.
+ */
+using KeyEventQueue = SpscQueue<KeyEvent, 256>;
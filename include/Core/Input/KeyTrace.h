@@ -0,0 +1,116 @@
+// include/Input/KeyTrace.h
+
+#pragma once
+#include "Core/Input/KeyEvent.h"
+#include "Core/Util/Span.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file KeyTrace.h
+ * @brief A compact binary format for recorded key events.
+ *
+ * A trace starts with a 12-byte header:
+ * - the magic bytes "RFXT";
+ * - the format version (uint16, little-endian);
+ * - two reserved bytes (zero);
+ * - the color seed of the recorded session (uint32, little-endian).
+ *
+ * Then comes one record per event, each made of three LEB128 varints:
+ * - the number of polls since the previous event (0 for events delivered by the same poll);
+ * - the milliseconds since the previous event's timestamp (modulo 2^32);
+ * - `keyIndex << 1 | action`, with 0 for a press and 1 for a release.
+ *
+ * Typing produces records of 3 to 5 bytes. Storing the poll index makes a
+ * replay deliver every event on the same frame as the recording did, which,
+ * together with the seed, makes the replayed frames identical.
+ */
+
+/**
+ * @class KeyTraceWriter
+ * @brief Encodes key events into the trace format, in memory.
+ *
+ * @author Michele Bisignano
+ */
+class KeyTraceWriter {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 12;
+
+    /**
+     * @brief Starts a trace; the header is the first thing in the buffer.
+     * @param seed The color seed of the session being recorded.
+     */
+    explicit KeyTraceWriter(uint32_t seed);
+
+    /**
+     * @brief Appends an event.
+     * @param pollIndex The poll that delivered the event. Must not decrease.
+     * @param event The event.
+     */
+    void append(uint32_t pollIndex, const KeyEvent& event);
+
+    /**
+     * @brief Gets the bytes encoded since construction or the last clear().
+     */
+    const std::vector<uint8_t>& getBytes() const { return bytes_; }
+
+    /**
+     * @brief Discards the encoded bytes, e.g. once they are written to a file.
+     *
+     * Later records are still encoded relative to the last appended event, so
+     * the concatenation of all the chunks is one valid trace.
+     */
+    void clear() { bytes_.clear(); }
+
+private:
+    void appendVarint(uint32_t value);
+
+    std::vector<uint8_t> bytes_;
+    uint32_t lastPollIndex_ = 0;
+    uint32_t lastTimestampMs_ = 0;
+};
+
+/**
+ * @class KeyTraceReader
+ * @brief Decodes key events from a trace held in memory.
+ *
+ * @author Michele Bisignano
+ */
+class KeyTraceReader {
+public:
+    /**
+     * @brief Parses the header. The bytes must outlive the reader.
+     */
+    explicit KeyTraceReader(Span<const uint8_t> bytes);
+
+    /**
+     * @brief Checks whether the header was valid.
+     */
+    bool isValid() const { return valid_; }
+
+    /**
+     * @brief Gets the color seed of the recorded session.
+     */
+    uint32_t getSeed() const { return seed_; }
+
+    /**
+     * @brief Decodes the next event.
+     * @param pollIndex Receives the poll that delivered the event.
+     * @param event Receives the event.
+     * @return false at the end of the trace, or at a truncated or malformed record
+     *         (after which isValid() is false).
+     */
+    bool next(uint32_t& pollIndex, KeyEvent& event);
+
+private:
+    bool readVarint(uint32_t& value);
+
+    Span<const uint8_t> bytes_;
+    size_t offset_ = 0;
+    bool valid_ = false;
+    uint32_t seed_ = 0;
+    uint32_t pollIndex_ = 0;
+    uint32_t timestampMs_ = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include "Core/Util/SpscQueue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class PcmRing
+ * @brief A lock-free stream of mono audio samples, from one reader to one effect.
+ *
+ * The producer (e.g. a PcmInput reader thread, or an I2S interrupt on a
+ * microcontroller) pushes signed 16-bit samples in blocks; the consumer (a
+ * SpectrumEffect, on the simulation thread) drains everything that arrived
+ * since the last frame. Neither side blocks or allocates. When the consumer
+ * falls behind by more than CAPACITY samples, the newest samples are dropped
+ * until it catches up, and it keeps only the newest ones it finds, so a stall
+ * never turns into a lasting delay.
+ *
+ * @author Michele Bisignano
+ */
+class PcmRing {
+public:
+    // About 185 ms at 44.1 kHz: many frames of slack, so the reader never has to wait.
+    static constexpr size_t CAPACITY = 8192;
+
+    /**
+     * @brief Constructs an empty, open stream.
+     * @param sampleRate The sample rate of the audio, in Hz.
+     */
+    explicit PcmRing(uint32_t sampleRate) : sampleRate_(sampleRate) {}
+
+    PcmRing(const PcmRing&) = delete;
+    PcmRing& operator=(const PcmRing&) = delete;
+
+    /**
+     * @brief Gets the sample rate of the audio, in Hz.
+     */
+    uint32_t getSampleRate() const { return sampleRate_; }
+
+    // --- Producer side ---
+
+    /**
+     * @brief Appends a block of samples, as many as there is room for.
+     * @return The number of samples queued.
+     */
+    size_t push(const int16_t* samples, size_t count) { return samples_.tryPushSome(samples, count); }
+
+    /**
+     * @brief Marks the end of the stream. Samples already queued can still be read.
+     */
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // --- Consumer side ---
+
+    /**
+     * @brief Removes up to `count` of the oldest samples.
+     * @return The number of samples removed.
+     */
+    size_t pop(int16_t* samples, size_t count) { return samples_.tryPopSome(samples, count); }
+
+    /**
+     * @brief Checks whether the stream has ended and every sample was read.
+     */
+    bool isFinished() const { return closed_.load(std::memory_order_acquire) && samples_.empty(); }
+
+private:
+    const uint32_t sampleRate_;
+    SpscQueue<int16_t, CAPACITY> samples_;
+    std::atomic<bool> closed_{ false };
+};
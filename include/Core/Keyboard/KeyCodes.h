@@ -1,6 +1,7 @@
 // include/Keyboard/KeyCodes.h
 
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 // This file defines unique identifiers for each key.
@@ -67,4 +68,9 @@ enum class KeyCode {
     OEM_102,        // Special key on non-US 102-key keyboards, often `< >` or `\|`
 
     KEY_COUNT
-};
\ No newline at end of file
+};
+
+// Upper bound on the number of keys a keyboard layout can contain. Sizes the
+// fixed KeyMask snapshots of the keyboard state. Effects and the LightingManager
+// size their per-key buffers for the topology they run on instead.
+constexpr size_t MAX_KEYS = static_cast<size_t>(KeyCode::KEY_COUNT);
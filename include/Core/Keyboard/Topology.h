@@ -0,0 +1,239 @@
+#pragma once
+#include "Core/Keyboard/Key.h"
+#include "Core/Util/Position.h"
+#include "Core/Util/Span.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief How a Topology stores its neighbor lists, by the type of a neighbor index.
+ *
+ * Small topologies (a keyboard) use 1-byte indices with 2-byte offsets, and
+ * also get one neighbor mask per point, so a wavefront grows with a few word
+ * ORs. Larger ones use 2-byte indices with 4-byte offsets and no masks, which
+ * would grow with the square of the point count.
+ */
+template<typename Index>
+struct NeighborIndexTraits;
+
+template<>
+struct NeighborIndexTraits<uint8_t> {
+    using Offset = uint16_t;
+    static constexpr size_t MAX_POINTS = 0xFF;
+    static constexpr bool HAS_MASKS = true;
+};
+
+template<>
+struct NeighborIndexTraits<uint16_t> {
+    using Offset = uint32_t;
+    static constexpr size_t MAX_POINTS = 0xFFFF;
+    static constexpr bool HAS_MASKS = false;
+};
+
+/**
+ * @class Topology
+ * @brief A set of lights (keys or LEDs) with positions and neighbor relations.
+ *
+ * This is the model that effects and the LightingManager run on. It stores:
+ * - the points, as Keys indexed by Key::getIndex();
+ * - the adjacency in compressed-sparse-row (CSR) form: the neighbors of all
+ *   points are stored back to back, so walking them is a contiguous read. The
+ *   index width follows NeighborIndexTraits: 1 byte up to 255 points, 2 bytes
+ *   beyond;
+ * - for 1-byte topologies, the neighbors of every point as a bitmask too
+ *   (see hasNeighborMasks());
+ * - optionally, the all-pairs hop-distance table. It grows with the square of
+ *   the point count, so it is only built for small topologies (see
+ *   MAX_HOP_TABLE_POINTS); use hasHopDistances() to check.
+ *
+ * The data is either owned (topologies built at runtime with fromPoints()) or
+ * a view of constant data in read-only memory (the Keyboard).
+ *
+ * @author Michele Bisignano
+ */
+class Topology {
+public:
+    /**
+     * @brief Default distance under which two points are neighbors, in key units.
+     *        Manhattan distance is used, which suits grid-like layouts.
+     */
+    static constexpr float DEFAULT_NEIGHBOR_DISTANCE = 1.6f;
+
+    /**
+     * @brief Largest topology for which fromPoints() builds the hop-distance table (1 MB).
+     */
+    static constexpr size_t MAX_HOP_TABLE_POINTS = 1024;
+
+    /**
+     * @brief Largest number of points in a topology: indices are at most 16 bits.
+     */
+    static constexpr size_t MAX_POINTS = NeighborIndexTraits<uint16_t>::MAX_POINTS;
+
+    /**
+     * @brief Marker stored in the hop-distance table for pairs of points with no path between them.
+     */
+    static constexpr uint8_t UNREACHABLE_HOPS = 0xFF;
+
+    /**
+     * @brief Builds a topology from an arbitrary list of points, e.g. an LED wall or strip.
+     *
+     * Neighbors are found with a sparse spatial grid: every point is bucketed
+     * into a cell `neighborDistance` wide, only the occupied cells are kept (in
+     * a hash table), and only the 3x3 block of cells around a point is
+     * searched. The points a search visits are bounded by the neighbors it
+     * finds, so the build takes time linear in the points plus the neighbor
+     * pairs, however the points are clustered or spread, and tens of thousands
+     * of points build in milliseconds.
+     *
+     * Point i gets the index i and the id i.
+     *
+     * @param points The positions of the lights. At most MAX_POINTS.
+     * @param neighborDistance Points closer than this (Manhattan distance) are neighbors.
+     * @throws std::length_error If there are more than MAX_POINTS points.
+     */
+    static Topology fromPoints(Span<const Position> points, float neighborDistance = DEFAULT_NEIGHBOR_DISTANCE);
+
+    Topology(const Topology&) = delete;
+    Topology& operator=(const Topology&) = delete;
+    Topology(Topology&&) = default;
+    Topology& operator=(Topology&&) = default;
+
+    /**
+     * @brief Gets all the points as Keys.
+     * @return A view of the keys, indexed by Key::getIndex().
+     */
+    Span<const Key> getKeys() const { return keys_; }
+
+    /**
+     * @brief Calls `fn(neighbor)` for every immediate neighbor of a point, in ascending index order.
+     * @param index The point's index (Key::getIndex()).
+     */
+    template<typename Fn>
+    void forEachNeighbor(size_t index, Fn&& fn) const {
+        if (!compactOffsets_.empty()) {
+            for (uint16_t n = compactOffsets_[index]; n < compactOffsets_[index + 1]; ++n) fn(size_t{ compactIndices_[n] });
+        }
+        else {
+            for (uint32_t n = wideOffsets_[index]; n < wideOffsets_[index + 1]; ++n) fn(size_t{ wideIndices_[n] });
+        }
+    }
+
+    /**
+     * @brief Checks whether the neighbor masks are available (topologies of up to 255 points).
+     */
+    bool hasNeighborMasks() const { return !neighborMasks_.empty(); }
+
+    /**
+     * @brief Gets the number of 64-bit words in a bitmask over the points (see KeyBitset).
+     */
+    size_t getMaskWords() const { return (keys_.size() + 63) / 64; }
+
+    /**
+     * @brief Gets the neighbors of a point as a bitmask over point indices.
+     *
+     * This is the same adjacency as forEachNeighbor(), so propagation-based
+     * effects can expand a whole wavefront with a few OR operations instead
+     * of walking lists.
+     * @param index The point's index (Key::getIndex()).
+     * @return A view of getMaskWords() words.
+     * @note Requires hasNeighborMasks().
+     */
+    Span<const uint64_t> getNeighborMask(size_t index) const {
+        return Span<const uint64_t>(neighborMasks_.data() + index * getMaskWords(), getMaskWords());
+    }
+
+    /**
+     * @brief Checks whether the hop-distance table is available.
+     */
+    bool hasHopDistances() const { return !hopDistances_.empty(); }
+
+    /**
+     * @brief Gets the number of neighbor hops on the shortest path between two points.
+     * @param from The index of the first point (Key::getIndex()).
+     * @param to The index of the second point.
+     * @return The hop distance, 0 for the same point, or UNREACHABLE_HOPS if no path exists.
+     * @note Requires hasHopDistances().
+     */
+    uint8_t getHopDistance(size_t from, size_t to) const {
+        return hopDistances_[from * keys_.size() + to];
+    }
+
+    /**
+     * @brief Gets the hop distances from one point to every point, as one row of the table.
+     * @param from The index of the source point.
+     * @return A view of getKeys().size() distances, indexed by Key::getIndex().
+     * @note Requires hasHopDistances().
+     */
+    Span<const uint8_t> getHopDistances(size_t from) const {
+        return Span<const uint8_t>(hopDistances_.data() + from * keys_.size(), keys_.size());
+    }
+
+protected:
+    /**
+     * @brief Constructs a topology viewing data that outlives it, e.g. constant tables.
+     * @tparam Index The neighbor index type, see NeighborIndexTraits.
+     * @param keys The points, indexed by Key::getIndex().
+     * @param neighborOffsets keys.size() + 1 offsets into `neighborIndices`.
+     * @param neighborIndices The CSR neighbor lists.
+     * @param neighborMasks keys.size() rows of getMaskWords() words, or an empty
+     *        view. Only 1-byte topologies have masks.
+     * @param hopDistances The row-major all-pairs hop distances, or an empty view.
+     */
+    template<typename Index>
+    Topology(Span<const Key> keys, Span<const typename NeighborIndexTraits<Index>::Offset> neighborOffsets,
+        Span<const Index> neighborIndices, Span<const uint64_t> neighborMasks, Span<const uint8_t> hopDistances);
+
+private:
+    Topology() = default;
+
+    template<typename Index>
+    void setNeighbors(Span<const typename NeighborIndexTraits<Index>::Offset> offsets, Span<const Index> indices);
+
+    void buildNeighborMasks();
+    void buildHopDistanceTable();
+
+    Span<const Key> keys_;
+    // Only one of the two CSR layouts is in use; the other one is empty.
+    Span<const uint16_t> compactOffsets_;
+    Span<const uint8_t> compactIndices_;
+    Span<const uint32_t> wideOffsets_;
+    Span<const uint16_t> wideIndices_;
+    Span<const uint64_t> neighborMasks_;
+    Span<const uint8_t> hopDistances_;
+
+    // Storage for topologies built at runtime. Empty when viewing constant data.
+    std::vector<Key> ownedKeys_;
+    std::vector<uint16_t> ownedCompactOffsets_;
+    std::vector<uint8_t> ownedCompactIndices_;
+    std::vector<uint32_t> ownedWideOffsets_;
+    std::vector<uint16_t> ownedWideIndices_;
+    std::vector<uint64_t> ownedNeighborMasks_;
+    std::vector<uint8_t> ownedHopDistances_;
+};
+
+template<typename Index>
+Topology::Topology(Span<const Key> keys, Span<const typename NeighborIndexTraits<Index>::Offset> neighborOffsets,
+    Span<const Index> neighborIndices, Span<const uint64_t> neighborMasks, Span<const uint8_t> hopDistances)
+    : keys_(keys),
+    neighborMasks_(neighborMasks),
+    hopDistances_(hopDistances)
+{
+    assert(keys.size() <= NeighborIndexTraits<Index>::MAX_POINTS && "Too many keys for the neighbor index type.");
+    assert((neighborMasks.empty() || NeighborIndexTraits<Index>::HAS_MASKS) && "Only 1-byte topologies have neighbor masks.");
+    setNeighbors<Index>(neighborOffsets, neighborIndices);
+}
+
+template<typename Index>
+void Topology::setNeighbors(Span<const typename NeighborIndexTraits<Index>::Offset> offsets, Span<const Index> indices) {
+    if constexpr (std::is_same_v<Index, uint8_t>) {
+        compactOffsets_ = offsets;
+        compactIndices_ = indices;
+    }
+    else {
+        wideOffsets_ = offsets;
+        wideIndices_ = indices;
+    }
+}
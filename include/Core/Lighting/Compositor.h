@@ -0,0 +1,158 @@
+#pragma once
+#include "Core/Util/Color.h"
+#include "Core/Util/Span.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief A color packed into one 32-bit word, 8 bits per channel.
+ *
+ * In memory the bytes are ordered red, green, blue, alpha, which on a
+ * little-endian CPU reads as `R | G << 8 | B << 16 | A << 24`. Four packed
+ * pixels fit in a 128-bit SIMD register, so a whole frame can be blended with
+ * a handful of saturating byte additions. Color has exactly this layout, so a
+ * buffer of Colors can be blended in place (see Color::toRGBA8()).
+ */
+using PackedColor = uint32_t;
+
+/**
+ * @enum BlendMode
+ * @brief How a layer's pixels are combined with the layers below it.
+ */
+enum class BlendMode : uint8_t {
+    Add,       // Saturating sum: overlapping light gets brighter.
+    Max,       // Per-channel maximum: overlapping light never exceeds its brightest source.
+    AlphaOver, // The layer's alpha mixes it over what is below.
+    Multiply,  // Per-channel product: the layer tints or masks what is below.
+    Replace    // The layer's color wins outright.
+};
+
+/**
+ * @class Compositor
+ * @brief Blends packed RGBA8 frame buffers with saturating byte arithmetic.
+ *
+ * The compositor provides one kernel in several implementations:
+ * - Scalar: portable SWAR code that adds two pixels per 64-bit word. Used on
+ *   microcontrollers and any CPU without a SIMD path.
+ * - SSE2: `_mm_adds_epu8`, four pixels per instruction. Baseline on x86-64.
+ * - AVX2: `_mm256_adds_epu8`, eight pixels per instruction.
+ *
+ * The fastest kernel supported by the running CPU is selected once, at the
+ * first call. Defining RIPPLEFX_COMPOSITOR_SCALAR at build time forces the
+ * scalar kernel everywhere.
+ *
+ * @author Michele Bisignano
+ */
+class Compositor {
+public:
+    /**
+     * @enum Kernel
+     * @brief The available implementations of the blending kernel.
+     */
+    enum class Kernel { Scalar, SSE2, AVX2 };
+
+    /**
+     * @brief Packs a Color into the RGBA8 frame buffer format.
+     */
+    static constexpr PackedColor pack(const Color& color) {
+        return color.toRGBA8();
+    }
+
+    /**
+     * @brief Unpacks an RGBA8 pixel into a Color.
+     */
+    static constexpr Color unpack(PackedColor packed) {
+        return Color::fromRGBA8(packed);
+    }
+
+    /**
+     * @brief Blends one pixel of a layer over the pixel below it.
+     *
+     * All modes use Q8 fixed point. With an `opacity` below 255 the result is
+     * mixed back towards `dst`, so a half-opaque Replace layer shows half of
+     * each. The result keeps the alpha of `dst`: layers only ever change
+     * the color of the frame, never its opacity.
+     * @param mode How the pixels are combined.
+     * @param dst The pixel below (the frame so far).
+     * @param src The layer's pixel.
+     * @param opacity The layer's opacity (0=invisible, 255=fully applied).
+     */
+    static constexpr Color blendPixel(BlendMode mode, const Color& dst, const Color& src, uint8_t opacity = 255) {
+        Color result = src;
+        switch (mode) {
+        case BlendMode::Add:
+            result = dst.add(src);
+            break;
+        case BlendMode::Max:
+            result = Color(
+                dst.getRed() > src.getRed() ? dst.getRed() : src.getRed(),
+                dst.getGreen() > src.getGreen() ? dst.getGreen() : src.getGreen(),
+                dst.getBlue() > src.getBlue() ? dst.getBlue() : src.getBlue());
+            break;
+        case BlendMode::AlphaOver:
+            // The source alpha and the layer opacity combine into one weight.
+            opacity = static_cast<uint8_t>((src.getAlpha() * opacity + 255) >> 8);
+            break;
+        case BlendMode::Multiply:
+            result = Color(
+                multiply(dst.getRed(), src.getRed()),
+                multiply(dst.getGreen(), src.getGreen()),
+                multiply(dst.getBlue(), src.getBlue()));
+            break;
+        case BlendMode::Replace:
+            break;
+        }
+        if (opacity != 255) {
+            result = dst.blend(result, opacity);
+        }
+        return Color(result.getRed(), result.getGreen(), result.getBlue(), dst.getAlpha());
+    }
+
+    /**
+     * @brief Additively blends `src` into `dst`, clamping every channel at 255.
+     *
+     * Equivalent to `dst[i] = dst[i].add(src[i])` on Colors, for `count` pixels,
+     * using the kernel returned by activeKernel().
+     */
+    static void addSaturate(PackedColor* dst, const PackedColor* src, size_t count);
+
+    /**
+     * @brief Additively blends a buffer of Colors into another, in place.
+     *
+     * Same as the packed overload, operating directly on Color storage. Both
+     * spans must have the same size.
+     */
+    static void addSaturate(Span<Color> dst, Span<const Color> src);
+
+    /**
+     * @brief Gets the kernel that addSaturate() dispatches to on this machine.
+     */
+    static Kernel activeKernel();
+
+    /**
+     * @brief Checks whether a given kernel can run on this machine.
+     */
+    static bool isSupported(Kernel kernel);
+
+    /**
+     * @brief Runs a specific kernel. The kernel must be supported (see isSupported()).
+     */
+    static void addSaturate(Kernel kernel, PackedColor* dst, const PackedColor* src, size_t count);
+
+    /**
+     * @brief Gets a printable name for a kernel, e.g. "AVX2".
+     */
+    static const char* kernelName(Kernel kernel);
+
+private:
+    /**
+     * @brief Multiplies two Q8 components, so that 255 * x == x.
+     */
+    static constexpr uint8_t multiply(uint8_t a, uint8_t b) {
+        return static_cast<uint8_t>((a * b + 255) >> 8);
+    }
+
+    static void addSaturateScalar(PackedColor* dst, const PackedColor* src, size_t count);
+    static void addSaturateSse2(PackedColor* dst, const PackedColor* src, size_t count);
+    static void addSaturateAvx2(PackedColor* dst, const PackedColor* src, size_t count);
+};
@@ -3,66 +3,200 @@
  */
 #pragma once
 
-#include "Core/Effects/RippleEffect.h"
+#include "Core/Effects/IEffect.h"
+#include "Core/Keyboard/Topology.h"
+#include "Core/Util/StateBuffer.h"
 #include <array>
-#include <vector>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <cstddef> // For std::byte
+#include <cstdint>
 
- // Define the maximum number of effects that can be active at once.
+ // Define the default maximum number of effects that can be active at once.
 constexpr size_t MAX_ACTIVE_EFFECTS = 20;
 
 
+namespace EffectPoolDetail {
+
+// Whether T keeps per-key state in a StateBuffer, i.e. has a static stateSize(const Topology&).
+template<typename T, typename = void>
+struct HasKeyState : std::false_type {};
+
+template<typename T>
+struct HasKeyState<T, std::void_t<decltype(T::stateSize(std::declval<const Topology&>()))>> : std::true_type {};
+
+} // namespace EffectPoolDetail
+
 /**
- * @brief Manages a pre-allocated memory pool for RippleEffect objects.
+ * @brief Manages a pre-allocated slab memory pool for effect objects of any type.
  * @author Michele Bisignano
  *
- * This class implements a memory management pattern known as a "Pool Allocator".
+ * This class implements a memory management pattern known as a "Slab Allocator".
  * Its purpose is to eliminate real-time dynamic memory allocations (on the heap),
  * which can be slow and cause memory fragmentation, especially in
  * performance-critical applications like firmware or game engines.
  *
  * How it works:
- * 1. In the constructor, a single, large block of raw memory is allocated,
- *    sufficient to hold a predefined maximum number of RippleEffect objects.
- * 2. The `create()` method does not allocate new memory but uses "placement new"
- *    to construct a RippleEffect object in an already available memory slot
- *    within the pool.
- * 3. The `destroy()` method does not deallocate memory; instead, it explicitly calls
- *    the object's destructor and marks the memory slot as available again
- *    for future use.
+ * 1. The pool is configured with a few size classes, each one a number of
+ *    equally sized slots. In the constructor, a single block of raw memory is
+ *    allocated for all of them; this is the only heap allocation the pool makes.
+ * 2. The free slots of each class are chained into an intrusive singly linked
+ *    list: a free slot stores the pointer to the next free slot in its own bytes,
+ *    so no bookkeeping container is needed.
+ * 3. The `create()` method pops the head of the smallest class that fits the
+ *    requested type (falling back to larger classes when it is exhausted) and
+ *    uses "placement new" to construct the object there. This is O(1).
+ * 4. The `destroy()` method finds the slot's class with an address range check,
+ *    explicitly calls the object's (virtual) destructor and pushes the slot back
+ *    onto the free list. This is also O(1).
+ *
+ * Any IEffect subclass can be pooled, as long as it fits in the largest size
+ * class and is not over-aligned. Every slot is aligned to SLOT_ALIGN.
+ *
+ * Effects with per-key state (those with a static `stateSize(const Topology&)`,
+ * see StateBuffer) take a Topology as their first constructor argument. Their
+ * slot holds the object followed by its state, so their slot size depends on
+ * the topology: size the classes with slotSizeFor<T>(topology).
  *
  * @note This implementation is not thread-safe.
  * @note The caller is responsible for calling `destroy()` for every object created
- *       with `create()`. The class returns raw pointers (`RippleEffect*`), and their
+ *       with `create()`. The class returns raw pointers (e.g. `RippleEffect*`), and their
  *       lifecycle management depends on the correct use of the pool.
- * @see RippleEffect
+ * @see IEffect
  */
 class EffectPool {
 public:
+    /**
+     * @struct SizeClass
+     * @brief Describes one size class: `slotCount` slots of at least `slotSize` bytes.
+     */
+    struct SizeClass {
+        size_t slotSize;
+        size_t slotCount;
+    };
+
+    // The alignment of every slot; enough for any type with fundamental alignment.
+    static constexpr size_t SLOT_ALIGN = alignof(std::max_align_t);
+
+    // The maximum number of size classes a pool can be configured with.
+    static constexpr size_t MAX_SIZE_CLASSES = 5;
+
+    /**
+     * @brief Gets the slot size needed to hold an object of type T.
+     */
+    template<typename T>
+    static constexpr size_t slotSizeFor() {
+        return (sizeof(T) + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+    }
+
+    /**
+     * @brief Gets the slot size needed to hold an effect of type T and its per-key state for a topology.
+     *
+     * For an effect with no per-key state, this is slotSizeFor<T>().
+     */
+    template<typename T>
+    static size_t slotSizeFor(const Topology& topology) {
+        if constexpr (HAS_KEY_STATE<T>) {
+            return slotSizeFor<T>() + T::stateSize(topology);
+        }
+        else {
+            return slotSizeFor<T>();
+        }
+    }
+
     /**
      * @brief Constructs the memory pool, pre-allocating all necessary memory.
+     * @param sizeClasses The size classes of the pool, at most MAX_SIZE_CLASSES.
+     *        Slot sizes are rounded up to a multiple of SLOT_ALIGN.
      */
-    EffectPool();
+    explicit EffectPool(std::initializer_list<SizeClass> sizeClasses);
+
+    EffectPool(const EffectPool&) = delete;
+    EffectPool& operator=(const EffectPool&) = delete;
 
     /**
-     * @brief Creates a RippleEffect object within the pre-allocated pool.
-     * @return A pointer to the new effect, or nullptr if the pool is full.
+     * @brief Creates an effect object within the pre-allocated pool.
+     * @tparam T The concrete effect type.
+     * @param args The constructor arguments. For an effect with per-key state,
+     *        the topology comes first and the StateBuffer is filled in by the pool.
+     * @return A pointer to the new effect, or nullptr if no slot large enough is free.
      */
-    template<typename... Args>
-    RippleEffect* create(Args&&... args);
+    template<typename T, typename... Args>
+    T* create(Args&&... args);
 
     /**
      * @brief Returns an effect object's memory to the pool.
-     * @param effect A pointer to the effect to be destroyed.
+     * @param effect A pointer to the effect to be destroyed. Must come from create().
+     */
+    void destroy(IEffect* effect);
+
+    /**
+     * @brief Gets the total number of slots across all size classes.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Gets the number of slots currently holding an effect.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Gets the largest number of slots ever in use at once.
+     */
+    size_t highWaterMark() const;
+
+    /**
+     * @brief Gets how many create() calls found no free slot large enough.
      */
-    void destroy(RippleEffect* effect);
+    uint64_t rejectedCount() const;
 
 private:
-    // A large block of raw memory to hold all our RippleEffect objects.
-    std::array<std::byte, sizeof(RippleEffect)* MAX_ACTIVE_EFFECTS> memoryPool_;
+    template<typename T>
+    static constexpr bool HAS_KEY_STATE = EffectPoolDetail::HasKeyState<T>::value;
+
+    /**
+     * @brief Creates an effect with per-key state: the object, then its state, in one slot.
+     */
+    template<typename T, typename... Args>
+    T* createWithState(const Topology& topology, Args&&... args);
+
+    /**
+     * @struct FreeSlot
+     * @brief The view of a free slot's memory: a link to the next free slot.
+     */
+    struct FreeSlot {
+        FreeSlot* next;
+    };
 
-    // A simple list to keep track of which "rooms" (pointers) are free.
-    std::vector<RippleEffect*> freeSlots_;
+    /**
+     * @struct Slab
+     * @brief The contiguous memory of one size class and its free list.
+     */
+    struct Slab {
+        std::byte* begin = nullptr;
+        std::byte* end = nullptr;
+        size_t slotSize = 0;
+        FreeSlot* freeList = nullptr;
+    };
+
+    /**
+     * @brief Takes a free slot of at least `size` bytes, or returns nullptr.
+     */
+    void* allocate(size_t size);
+
+    // The single block of raw memory backing every slab.
+    std::unique_ptr<std::byte[]> memory_;
+
+    // Slabs ordered by increasing slot size.
+    std::array<Slab, MAX_SIZE_CLASSES> slabs_{};
+    size_t slabCount_ = 0;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t highWaterMark_ = 0;
+    uint64_t rejected_ = 0;
 };
 
 // --- Template Implementation must be in the header file ---
@@ -70,20 +204,35 @@ private:
 /**
  * @author Michele Bisignano
  */
-template<typename... Args>
-RippleEffect* EffectPool::create(Args&&... args) {
-    if (freeSlots_.empty()) {
-        // No available "rooms" in our hotel.
-        return nullptr;
+template<typename T, typename... Args>
+T* EffectPool::create(Args&&... args) {
+    static_assert(std::is_base_of_v<IEffect, T>, "Only IEffect types can be pooled.");
+    static_assert(alignof(T) <= SLOT_ALIGN, "Effect type is over-aligned for the pool.");
+
+    if constexpr (HAS_KEY_STATE<T>) {
+        return createWithState<T>(std::forward<Args>(args)...);
     }
+    else {
+        void* slot = allocate(sizeof(T));
+        if (!slot) {
+            // No available "rooms" of the right size in our hotel.
+            return nullptr;
+        }
 
-    // Get a free memory slot from the back of the list.
-    RippleEffect* slot = freeSlots_.back();
-    freeSlots_.pop_back();
+        // Use "placement new" to construct the effect object directly in that memory slot.
+        // This does NOT allocate new memory; it just calls the constructor.
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+}
 
-    // Use "placement new" to construct a RippleEffect object directly in that memory slot.
-    // This does NOT allocate new memory; it just calls the constructor.
-    new (slot) RippleEffect(std::forward<Args>(args)...);
+template<typename T, typename... Args>
+T* EffectPool::createWithState(const Topology& topology, Args&&... args) {
+    const size_t stateSize = T::stateSize(topology);
+    std::byte* slot = static_cast<std::byte*>(allocate(slotSizeFor<T>() + stateSize));
+    if (!slot) {
+        return nullptr;
+    }
 
-    return slot;
-}
\ No newline at end of file
+    // The state starts at the first SLOT_ALIGN boundary after the object.
+    return new (slot) T(topology, StateBuffer(slot + slotSizeFor<T>(), stateSize), std::forward<Args>(args)...);
+}
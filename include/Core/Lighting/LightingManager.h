@@ -1,11 +1,62 @@
 #pragma once
 
 #pragma once
-#include "Core/Keyboard/Keyboard.h"
+#include "Core/Keyboard/Topology.h"
 #include "Core/Effects/IEffect.h"
+#include "Core/Effects/RippleFieldEffect.h"
+#include "Core/Effects/SparksEffect.h"
+#include "Core/Effects/SpectrumEffect.h"
+#include "Core/Input/PcmRing.h"
+#include "Core/Lighting/Compositor.h"
 #include "Core/Lighting/EffectPool.h"
+#include "Core/Output/LedEncoder.h"
+#include "Core/Util/KeySet.h"
+#include <array>
+#include <cstdint>
 #include <vector>
 
+// The number of effect layers. Each one costs a frame-sized scratch buffer,
+// allocated up front. Raise it with -DRIPPLEFX_MAX_LAYERS=<n>.
+#if defined(RIPPLEFX_MAX_LAYERS)
+constexpr size_t MAX_LAYERS = RIPPLEFX_MAX_LAYERS;
+#else
+constexpr size_t MAX_LAYERS = 4;
+#endif
+static_assert(MAX_LAYERS >= 1 && MAX_LAYERS <= 256, "Layer indices are 8-bit.");
+
+/**
+ * @enum EvictionPolicy
+ * @brief What the LightingManager does when a new effect arrives while it is full.
+ */
+enum class EvictionPolicy {
+    DropNew,             // Ignore the new effect.
+    StealOldest,         // Replace the effect that started first.
+    StealDimmest,        // Replace the effect with the lowest IEffect::getIntensity().
+    StealLowestPriority  // Replace the lowest-priority effect (the oldest among equals),
+                         // unless every active effect outranks the new one.
+};
+
+/**
+ * @enum SharedEffects
+ * @brief The optional shared effects a LightingManager reserves a pool slot for, combined with `|`.
+ *
+ * The ripple field always has its slot. The others are large (a SparksEffect
+ * keeps MAX_PARTICLES particles), so a build only pays for the ones it uses.
+ */
+enum class SharedEffects : uint8_t {
+    None = 0,
+    Sparks = 1 << 0,   // addSparks()
+    Spectrum = 1 << 1, // addSpectrum()
+};
+
+constexpr SharedEffects operator|(SharedEffects lhs, SharedEffects rhs) {
+    return static_cast<SharedEffects>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+}
+
+constexpr bool includes(SharedEffects set, SharedEffects effect) {
+    return (static_cast<uint8_t>(set) & static_cast<uint8_t>(effect)) != 0;
+}
+
 /**
  * @class LightingManager
  * @brief Orchestrates all active lighting effects and renders the final frame.
@@ -13,6 +64,13 @@
  * This class is the core of the lighting engine. It maintains a list of
  * active effects, updates them each frame, removes finished ones, and blends
  * their outputs into a final framebuffer to be sent to the hardware.
+ *
+ * Every effect belongs to one of MAX_LAYERS ordered layers, layer 0 at the
+ * bottom. Effects on the same layer add up; each layer is then blended over
+ * the ones below with its own BlendMode and opacity. A layer records which keys
+ * its effects lit (its coverage), so layers with no effects and keys no layer
+ * covers cost nothing. By default every layer uses BlendMode::Add, which gives
+ * the same frame as one big additive layer.
  * 
  * @author Michele Bisignano
  */
@@ -20,12 +78,26 @@ class LightingManager {
 public:
     /**
      * @brief Constructs the LightingManager.
-     * @param keyboard A pointer to the keyboard model. The manager does not own this pointer.
+     * @param topology A pointer to the keyboard model, or any other Topology (e.g. an LED wall).
+     *        The manager does not own this pointer. Every per-key buffer, and
+     *        the pool slots of effects with per-key state, are sized for it here.
+     * @param maxActiveEffects The maximum number of effects that can be active at once.
+     *        All the memory for them is reserved here, up front.
+     * @param evictionPolicy What to do when an effect is added while the manager is full.
+     *        Stealing the oldest effect by default means a fast typist never presses a dead key.
+     * @param sharedEffects The optional shared effects to reserve a pool slot for. The
+     *        others cost no memory, and adding them does nothing.
      */
-    explicit LightingManager(Keyboard* keyboard);
+    explicit LightingManager(Topology* topology, size_t maxActiveEffects = MAX_ACTIVE_EFFECTS,
+        EvictionPolicy evictionPolicy = EvictionPolicy::StealOldest, SharedEffects sharedEffects = SharedEffects::None);
 
     /**
      * @brief Updates all active effects and renders the next frame. This should be called once per frame.
+     *
+     * Only keys that were lit in the previous frame or are lit in this one are
+     * visited, and the ones whose color actually changed are recorded in the
+     * dirty set. When there are no active effects and nothing is lit, the call
+     * returns immediately.
      */
     void update();
 
@@ -38,17 +110,143 @@ public:
      * manager's list of active effects, which will be updated and rendered in
      * subsequent frames.
      *
-     * @note If the EffectPool is full, the creation will fail, and this function
-     *       will do nothing (the request is silently ignored).
+     * @note If the manager already runs its maximum number of effects, an active
+     *       effect is evicted according to the eviction policy to make room. With
+     *       EvictionPolicy::DropNew the request is silently ignored instead.
      *
      * @param startKey The key where the ripple effect originates.
      * @param color The color of the ripple.
      * @param stepDuration The time in milliseconds for each step of the ripple's expansion.
      * @param propagationDelay The delay in milliseconds between each propagation step.
      * @param maxLifetime The total duration in milliseconds the effect should last before being removed.
+     * @param priority The priority of the effect, used by EvictionPolicy::StealLowestPriority.
+     * @param layer The layer the effect is drawn on, below MAX_LAYERS.
      * @see EffectPool::create()
      */
-    void addRippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime);
+    void addRippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime, int priority = 0, size_t layer = 0);
+
+    /**
+     * @brief Creates a new stateless, seekable ripple and adds it to the list of active effects.
+     *
+     * Takes the same parameters as addRippleEffect() and produces the same wave, but the
+     * effect is evaluated in closed form from the topology's hop-distance table.
+     * Like addRippleEffect(), an active effect may be evicted to make room.
+     * Topologies too large for a hop-distance table get a RippleEffect instead,
+     * which renders the same frames.
+     *
+     * @see SeekableRippleEffect
+     */
+    void addSeekableRippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime, int priority = 0, size_t layer = 0);
+
+    /**
+     * @brief Starts a ripple in the shared ripple field.
+     *
+     * Produces the same wave as addRippleEffect(), but every field ripple runs
+     * inside one RippleFieldEffect, so the cost of a frame does not grow with
+     * the number of ripples and this call never drops or evicts anything. The
+     * field has a pool slot of its own, is created on the first ripple, and
+     * is retired when it goes dark. It does not count towards `maxActiveEffects`
+     * and is never chosen for eviction.
+     *
+     * @param startKey The key where the ripple originates.
+     * @param color The color of the ripple.
+     * @param stepDuration The number of frames in each step of a key's fade.
+     * @param propagationDelay The number of frames between one ring of keys and the next.
+     * @param maxLifetime The total number of frames the ripple lives for.
+     * @see RippleFieldEffect
+     */
+    void addFieldRipple(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime);
+
+    /**
+     * @brief Sets the layer the ripple field is drawn on. Takes effect immediately.
+     */
+    void setRippleFieldLayer(size_t layer);
+
+    /**
+     * @brief Sends a burst of sparks flying out of a key.
+     *
+     * All sparks live in one shared SparksEffect which, like the ripple field,
+     * has a pool slot of its own, is created on demand, is retired once every
+     * spark is gone, and is never evicted. The slot is only reserved when the
+     * manager is constructed with SharedEffects::Sparks; otherwise no spark is emitted.
+     * @param origin The key the sparks come from.
+     * @param color The color of the sparks.
+     * @param count How many sparks to emit; capped by the free room among MAX_PARTICLES.
+     * @param lifetime How many frames the sparks take to fade out.
+     * @return The number of sparks emitted.
+     * @see SparksEffect
+     */
+    size_t addSparks(const Key& origin, const Color& color, size_t count, int lifetime);
+
+    /**
+     * @brief Sets the layer the sparks are drawn on. Takes effect immediately.
+     */
+    void setSparksLayer(size_t layer);
+
+    /**
+     * @brief Starts a spectrum analyzer on a stream of audio, or switches the running one to it.
+     *
+     * The analyzer is a shared SpectrumEffect: like the ripple field, it has a
+     * pool slot of its own and is never evicted. It runs until the stream ends
+     * and its bars have fallen. The slot is only reserved when the manager is
+     * constructed with SharedEffects::Spectrum; otherwise this does nothing.
+     * @param source The audio to analyze. Must outlive the analyzer.
+     * @param color The color of the bars.
+     * @see SpectrumEffect
+     */
+    void addSpectrum(PcmRing& source, const Color& color);
+
+    /**
+     * @brief Sets the layer the spectrum analyzer is drawn on. Takes effect immediately.
+     */
+    void setSpectrumLayer(size_t layer);
+
+    /**
+     * @brief Creates an effect that lights every key with one color, e.g. a backlight under the ripples.
+     *
+     * Like addRippleEffect(), an active effect may be evicted to make room.
+     * @param color The color. Its alpha is used by BlendMode::AlphaOver layers.
+     * @param maxLifetime The number of frames the effect lasts; 0 or less to keep it until clearLayer().
+     * @param priority The priority of the effect, used by EvictionPolicy::StealLowestPriority.
+     * @param layer The layer the effect is drawn on, below MAX_LAYERS.
+     * @see SolidColorEffect
+     */
+    void addSolidColorEffect(const Color& color, int maxLifetime = 0, int priority = 0, size_t layer = 0);
+
+    /**
+     * @brief Removes every effect on a layer.
+     */
+    void clearLayer(size_t layer);
+
+    /**
+     * @brief Sets how a layer is blended over the layers below it.
+     * @param layer The layer, below MAX_LAYERS.
+     * @param mode The blend mode.
+     * @param opacity The layer's opacity (0=invisible, 255=fully applied).
+     */
+    void setLayerBlendMode(size_t layer, BlendMode mode, uint8_t opacity = 255);
+
+    /**
+     * @brief Gets a layer's blend mode.
+     * @return The mode, or BlendMode::Add (the default) if `layer` is not below MAX_LAYERS.
+     */
+    BlendMode getLayerBlendMode(size_t layer) const;
+
+    /**
+     * @brief Gets a layer's opacity.
+     * @return The opacity, or 255 (the default) if `layer` is not below MAX_LAYERS.
+     */
+    uint8_t getLayerOpacity(size_t layer) const;
+
+    /**
+     * @brief Sets what to do when an effect is added while the manager is full.
+     */
+    void setEvictionPolicy(EvictionPolicy policy);
+
+    /**
+     * @brief Gets the current eviction policy.
+     */
+    EvictionPolicy getEvictionPolicy() const;
     
     /**
      * @brief Gets the final, blended colors for the current frame.
@@ -57,9 +255,137 @@ public:
      */
     const std::vector<Color>& getFrameBuffer() const;
 
+    /**
+     * @brief Gets the keys whose color changed in the last call to update().
+     *
+     * Hardware backends can use this to send only the changed keys, or nothing at
+     * all when the set is empty (e.g. while the keyboard is idle).
+     * @return A const reference to the set of changed key indices.
+     */
+    const KeySet& getDirtyKeys() const;
+
+    /**
+     * @brief Makes update() write every changed key straight into an LED wire-format buffer.
+     *
+     * The encoder is brought up to date with the current frame here; afterwards
+     * each update() re-encodes exactly the keys it marks dirty, in the same
+     * pass. Only use this when update() and the device transfer run on the same
+     * thread (e.g. single-threaded and firmware builds).
+     * @param encoder The encoder, sized for this topology, or nullptr to detach it.
+     *        The manager does not own it.
+     */
+    void setLedEncoder(LedEncoder* encoder);
+
+    /**
+     * @brief Checks whether the manager is idle: no active effects and an all-black frame.
+     *
+     * While idle, update() changes nothing, so a caller may stop calling it
+     * (and stop rendering) until a new effect is added.
+     */
+    bool isIdle() const;
+
 private:
-    Keyboard* keyboard_;
+    /**
+     * @struct ActiveEffect
+     * @brief An active effect and the bookkeeping used to pick eviction victims.
+     */
+    struct ActiveEffect {
+        IEffect* effect;
+        uint32_t serial; // Increases with every added effect, so lower is older.
+        int priority;
+        uint8_t layer;
+    };
+
+    /**
+     * @struct Layer
+     * @brief A layer's blending settings and the scratch space its effects render into.
+     */
+    struct Layer {
+        BlendMode mode = BlendMode::Add;
+        uint8_t opacity = 255;
+        size_t effectCount = 0;
+        std::vector<Color> pixels; // The layer's effects, summed. Transparent outside coverage.
+        KeySet coverage; // Keys lit by the layer's effects in the current frame.
+    };
+
+    /**
+     * @brief Creates an effect of type T in the pool and activates it.
+     */
+    template<typename T, typename... Args>
+    void addEffect(int priority, size_t layer, Args&&... args);
+
+    /**
+     * @brief Checks whether a layer can be drawn straight into the frame when nothing is below it.
+     */
+    static bool rendersInPlace(const Layer& layer);
+
+    /**
+     * @brief Blends the layers from `firstLayer` up into the frame, in one pass over the keys they cover.
+     *
+     * When every layer to blend is an opaque Add layer, each is summed into
+     * the frame on its own instead: whole, with Compositor::addSaturate(), if
+     * it covers at least 1/DENSE_LAYER_FRACTION of the keys.
+     */
+    void blendLayers(size_t firstLayer);
+
+    /**
+     * @brief Makes room for an effect of the given priority according to the eviction policy.
+     * @return true if a slot is free afterwards, false if the new effect must be dropped.
+     */
+    bool makeRoom(int priority);
+
+    /**
+     * @brief Destroys the active effect at `index` in O(1), moving the last one into its place.
+     */
+    void retire(size_t index);
+
+    /**
+     * @brief Gets the number of active effects that count towards `maxActiveEffects`.
+     */
+    size_t countedEffects() const;
+
+    /**
+     * @brief Checks whether an effect is one of the shared effects (the ripple field, the sparks or the spectrum).
+     */
+    bool isShared(const IEffect* effect) const;
+
+    /**
+     * @brief Creates a shared effect in its reserved slot and activates it, unless it is already active.
+     */
+    template<typename T>
+    T* activateShared(T*& shared, uint8_t layer);
+
+    /**
+     * @brief Moves an active effect to another layer.
+     */
+    void moveToLayer(const IEffect* effect, size_t layer);
+
+    Topology* topology_;
+    size_t maxActiveEffects_;
+    EvictionPolicy evictionPolicy_;
+    SharedEffects sharedEffects_;
+    uint32_t nextSerial_ = 0;
     EffectPool effectPool_;
-    std::vector<IEffect*> activeEffects_;
+    // Unordered: effects on a layer add up, and addition is commutative, so
+    // render order only matters between layers.
+    std::vector<ActiveEffect> activeEffects_;
+    std::array<Layer, MAX_LAYERS> layers_;
+    // An opaque Add layer covering at least 1/DENSE_LAYER_FRACTION of the keys
+    // is blended with the SIMD kernel over the whole frame, not key by key.
+    static constexpr size_t DENSE_LAYER_FRACTION = 4;
+    // The shared effects, also in activeEffects_ while they show anything.
+    static constexpr size_t SHARED_EFFECT_COUNT = 3;
+    RippleFieldEffect* rippleField_ = nullptr;
+    uint8_t rippleFieldLayer_ = 0;
+    SparksEffect* sparks_ = nullptr;
+    uint8_t sparksLayer_ = 0;
+    SpectrumEffect* spectrum_ = nullptr;
+    uint8_t spectrumLayer_ = 0;
+    KeySet layeredKeys_; // Keys covered by any layer blended in blendLayers(), scratch space.
     std::vector<Color> frameBuffer_; // One color for each key, indexed implicitly
+    KeySet litKeys_; // Keys written by any effect in the current frame; everything else is black.
+    KeySet previousLitKeys_; // litKeys_ of the previous frame, reused as scratch space.
+    KeySet dirtyKeys_; // Keys whose color differs from the previous frame.
+    std::vector<Color> previousFrame_; // The last frame, used to detect changed keys.
+    LedEncoder* ledEncoder_ = nullptr; // Optional wire-format mirror of frameBuffer_.
 };
\ No newline at end of file
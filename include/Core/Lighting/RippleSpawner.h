@@ -0,0 +1,63 @@
+#pragma once
+#include "Core/Keyboard/Key.h"
+#include "Core/Lighting/LightingManager.h"
+#include "Core/Util/Random.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class RippleSpawner
+ * @brief Turns key presses into ripples whose shape follows the typing rhythm.
+ *
+ * The faster the user types, the shorter and quicker the ripples: the time
+ * since the previous press sets the lifetime, the propagation delay and the
+ * fade step of the new ripple. All the math is integer shifts and compares.
+ *
+ * Colors come from a seeded Random, so the same seed and the same key events
+ * always produce the same ripples, which is what makes trace replay exact.
+ *
+ * @author Michele Bisignano
+ */
+class RippleSpawner {
+public:
+    static constexpr uint32_t DEFAULT_SEED = 1;
+
+    /**
+     * @brief Constructs the spawner.
+     * @param lightingManager The manager that receives the new ripples. Must outlive the spawner.
+     * @param startTimestampMs The time the first press is measured from, in milliseconds.
+     * @param seed The seed of the color generator.
+     */
+    explicit RippleSpawner(LightingManager& lightingManager, uint32_t startTimestampMs = 0, uint32_t seed = DEFAULT_SEED);
+
+    /**
+     * @brief Starts a ripple for a key press.
+     * @param key The pressed key.
+     * @param timestampMs The time of the press, in milliseconds, on the same clock as
+     *        `startTimestampMs`. Wrap-around of the 32-bit counter is handled.
+     */
+    void onKeyPress(const Key& key, uint32_t timestampMs);
+
+    /**
+     * @brief Chooses whether presses start ripples in the manager's shared ripple
+     *        field instead of one effect each.
+     *
+     * The waves look the same either way. In the field, typing faster never
+     * costs more per frame and never drops or evicts a ripple.
+     * @see LightingManager::addFieldRipple()
+     */
+    void setUseRippleField(bool useRippleField);
+
+    /**
+     * @brief Sets how many sparks fly out of each pressed key, in the ripple's color. 0 for none.
+     * @see LightingManager::addSparks()
+     */
+    void setSparksPerPress(size_t sparksPerPress);
+
+private:
+    LightingManager& lightingManager_;
+    uint32_t lastPressMs_;
+    Random rng_;
+    bool useRippleField_ = false;
+    size_t sparksPerPress_ = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include "Core/Output/WireFormat.h"
+#include "Core/Util/Color.h"
+#include "Core/Util/KeySet.h"
+#include "Core/Util/Span.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class LedEncoder
+ * @brief Keeps a ready-to-send wire-format image of the frame for an addressable LED strip.
+ *
+ * The buffer holds the complete transfer: header, one pixel per LED in the
+ * strip's wiring order and channel order, and trailer. It is allocated once,
+ * in the constructor, with the header and trailer already filled in; after
+ * that only pixels are rewritten, one key at a time. A device backend can
+ * hand data() to its SPI/RMT DMA engine as is.
+ *
+ * Attached to a LightingManager (see LightingManager::setLedEncoder()), the
+ * encoder is updated while the frame is diffed, for the changed keys only, so
+ * there is no separate conversion pass over the whole frame and no
+ * intermediate buffer in the backend.
+ *
+ * @note On microcontrollers whose DMA cannot reach every RAM region, allocate
+ *       the encoder in DMA-capable memory (on the ESP32, internal RAM).
+ *
+ * @author Michele Bisignano
+ */
+class LedEncoder {
+public:
+    /**
+     * @brief Constructs the encoder, with every LED black.
+     * @param format The strip's wire format.
+     * @param keyCount The number of keys in the frame buffer.
+     * @param ledForKey The position on the strip of every key, or an empty span
+     *        if the strip is wired in key order. Must hold `keyCount` distinct
+     *        positions below `keyCount`.
+     */
+    LedEncoder(const WireFormat& format, size_t keyCount, Span<const uint16_t> ledForKey = {});
+
+    /**
+     * @brief Rewrites the pixel of one key.
+     */
+    void encodeKey(size_t keyIndex, const Color& color) {
+        format_.encodePixel(color, buffer_.data() + pixelOffsets_[keyIndex]);
+    }
+
+    /**
+     * @brief Rewrites every pixel from a whole frame.
+     */
+    void encodeAll(Span<const Color> frame);
+
+    /**
+     * @brief Rewrites the pixels of the changed keys only.
+     */
+    void encodeChanges(Span<const Color> frame, const KeySet& dirtyKeys);
+
+    /**
+     * @brief Gets the bytes to send, header and trailer included.
+     */
+    Span<const uint8_t> data() const {
+        return Span<const uint8_t>(buffer_.data(), buffer_.size());
+    }
+
+    /**
+     * @brief Gets the byte offset of a key's pixel within data().
+     */
+    size_t pixelOffset(size_t keyIndex) const {
+        return pixelOffsets_[keyIndex];
+    }
+
+    const WireFormat& getFormat() const { return format_; }
+    size_t getKeyCount() const { return pixelOffsets_.size(); }
+
+private:
+    WireFormat format_;
+    std::vector<uint32_t> pixelOffsets_; // Byte offset of each key's pixel, by key index.
+    std::vector<uint8_t> buffer_;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include "Core/Util/Color.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct WireFormat
+ * @brief Describes how an addressable LED strip expects its pixels on the wire.
+ *
+ * A format is a plain value: an encoding, the order in which the color
+ * channels are sent and, for APA102, the global brightness field. Use one of
+ * the factory functions for the common parts:
+ * - ws2812(): 3 bytes per LED, green-red-blue (also SK6812 RGB, WS2811 in GRB).
+ * - apa102(): a 4-byte start frame, then per LED `0b111bbbbb` (5-bit global
+ *   brightness) followed by blue-green-red, then an end frame of 0xFF bytes
+ *   long enough to clock the data through the whole strip.
+ * - rgb565(): 2 bytes per LED, big-endian 5-6-5 bits, as SPI displays expect.
+ *
+ * encodePixel() writes one LED. It is constexpr and free of allocations, so
+ * the same code runs in LedEncoder and in anything that needs to check its output.
+ *
+ * @author Michele Bisignano
+ */
+struct WireFormat {
+    /**
+     * @enum Encoding
+     * @brief The pixel layouts supported on the wire.
+     */
+    enum class Encoding : uint8_t {
+        Rgb888, // One byte per channel, in `channelOrder`.
+        Apa102, // A brightness byte, then one byte per channel in `channelOrder`.
+        Rgb565  // 16 bits per pixel, big-endian; `channelOrder` is ignored.
+    };
+
+    // Channel indices used in `channelOrder`.
+    static constexpr uint8_t RED = 0;
+    static constexpr uint8_t GREEN = 1;
+    static constexpr uint8_t BLUE = 2;
+
+    // The largest value of the APA102 global brightness field.
+    static constexpr uint8_t APA102_MAX_BRIGHTNESS = 31;
+
+    Encoding encoding = Encoding::Rgb888;
+    uint8_t channelOrder[3] = { RED, GREEN, BLUE }; // The channel sent first, second and third.
+    uint8_t brightness = APA102_MAX_BRIGHTNESS; // APA102 only, 0..31.
+
+    /**
+     * @brief WS2812 ("NeoPixel") and compatible: GRB, 3 bytes per LED.
+     */
+    static constexpr WireFormat ws2812() {
+        return WireFormat{ Encoding::Rgb888, { GREEN, RED, BLUE }, APA102_MAX_BRIGHTNESS };
+    }
+
+    /**
+     * @brief APA102 / SK9822 ("DotStar"): BGR with a 5-bit global brightness, 4 bytes per LED.
+     * @param brightness The global brightness field, clamped to 0..31.
+     */
+    static constexpr WireFormat apa102(uint8_t brightness = APA102_MAX_BRIGHTNESS) {
+        return WireFormat{ Encoding::Apa102, { BLUE, GREEN, RED },
+            brightness < APA102_MAX_BRIGHTNESS ? brightness : APA102_MAX_BRIGHTNESS };
+    }
+
+    /**
+     * @brief RGB565, big-endian, 2 bytes per LED.
+     */
+    static constexpr WireFormat rgb565() {
+        return WireFormat{ Encoding::Rgb565, { RED, GREEN, BLUE }, APA102_MAX_BRIGHTNESS };
+    }
+
+    /**
+     * @brief Gets the number of bytes each LED takes on the wire.
+     */
+    constexpr size_t bytesPerLed() const {
+        switch (encoding) {
+        case Encoding::Apa102: return 4;
+        case Encoding::Rgb565: return 2;
+        default: return 3;
+        }
+    }
+
+    /**
+     * @brief Gets the number of bytes sent before the first LED.
+     */
+    constexpr size_t headerBytes() const {
+        return encoding == Encoding::Apa102 ? 4 : 0;
+    }
+
+    /**
+     * @brief Gets the number of bytes sent after the last LED of a strip of `ledCount`.
+     *
+     * APA102 needs at least one extra clock edge per two LEDs to push the data
+     * through, i.e. ledCount / 16 bytes, rounded up and never fewer than four.
+     */
+    constexpr size_t trailerBytes(size_t ledCount) const {
+        if (encoding != Encoding::Apa102) return 0;
+        const size_t bytes = (ledCount + 15) / 16;
+        return bytes < 4 ? 4 : bytes;
+    }
+
+    /**
+     * @brief Gets the size of a whole frame for `ledCount` LEDs, header and trailer included.
+     */
+    constexpr size_t frameBytes(size_t ledCount) const {
+        return headerBytes() + ledCount * bytesPerLed() + trailerBytes(ledCount);
+    }
+
+    /**
+     * @brief Writes the bytesPerLed() bytes of one LED showing `color`.
+     */
+    constexpr void encodePixel(const Color& color, uint8_t* out) const {
+        const uint8_t channels[3] = { color.getRed(), color.getGreen(), color.getBlue() };
+        switch (encoding) {
+        case Encoding::Rgb565: {
+            const uint16_t packed = static_cast<uint16_t>(
+                ((channels[RED] & 0xF8) << 8) | ((channels[GREEN] & 0xFC) << 3) | (channels[BLUE] >> 3));
+            out[0] = static_cast<uint8_t>(packed >> 8);
+            out[1] = static_cast<uint8_t>(packed);
+            break;
+        }
+        case Encoding::Apa102:
+            out[0] = static_cast<uint8_t>(0xE0 | brightness);
+            out[1] = channels[channelOrder[0]];
+            out[2] = channels[channelOrder[1]];
+            out[3] = channels[channelOrder[2]];
+            break;
+        default:
+            out[0] = channels[channelOrder[0]];
+            out[1] = channels[channelOrder[1]];
+            out[2] = channels[channelOrder[2]];
+            break;
+        }
+    }
+};
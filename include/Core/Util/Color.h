@@ -1,50 +1,87 @@
 // include/util/Color.h
 
 #pragma once
-#include <algorithm>
-#include <iomanip>
-#include <random>
-#include <sstream>
+#include "Core/Util/Random.h"
+#include <cstdint>
 #include <string>
+#include <type_traits>
 
 /**
  * @class Color
- * @brief Represents an immutable RGB color, optimized for embedded systems.
+ * @brief Represents an immutable RGBA color, optimized for embedded systems.
  *
- * The Color class models a color using red, green, and blue components (0-255 each).
- * It provides methods to scale brightness, blend with another color, and lighten the color.
+ * The Color class models a color using red, green, blue and alpha components
+ * (0-255 each), stored as four bytes in that order. It is 4 bytes in size,
+ * trivially copyable and usable in constant expressions, so a frame buffer of
+ * Colors has exactly the packed RGBA8 layout the Compositor works on.
+ *
+ * All arithmetic uses Q8 fixed point: a factor of 255 stands for 1.0. No
+ * method uses floating point or division. Alpha defaults to 255 (opaque) and
+ * is only meaningful to blend modes that use it.
  *
  * @author Michele Bisignano
  */
 class Color {
 public:
     /**
-     * @brief Constructs a Color object with specified RGB components.
+     * @brief Constructs opaque black.
+     */
+    constexpr Color() = default;
+
+    /**
+     * @brief Constructs a Color object with specified RGBA components.
      * @param red   Red component (0-255).
      * @param green Green component (0-255).
      * @param blue  Blue component (0-255).
+     * @param alpha Alpha component (0-255). Defaults to fully opaque.
      */
-    Color(int red, int green, int blue)
-        : red_(clamp(red)), green_(clamp(green)), blue_(clamp(blue)) {
+    constexpr Color(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = 255)
+        : red_(red), green_(green), blue_(blue), alpha_(alpha) {
+    }
+
+    /**
+     * @brief Constructs a Color from integer components that may be out of range.
+     *
+     * Use this when the components come from arithmetic that can overflow or
+     * underflow; each one is clamped to 0-255. The regular constructor does not
+     * clamp, so it costs nothing.
+     */
+    static constexpr Color clamped(int red, int green, int blue) {
+        return Color(clamp(red), clamp(green), clamp(blue));
     }
 
     /**
      * @brief Gets the red component.
      * @return Red value (0-255).
      */
-    int getRed() const { return red_; }
+    constexpr uint8_t getRed() const { return red_; }
 
     /**
      * @brief Gets the green component.
      * @return Green value (0-255).
      */
-    int getGreen() const { return green_; }
+    constexpr uint8_t getGreen() const { return green_; }
 
     /**
      * @brief Gets the blue component.
      * @return Blue value (0-255).
      */
-    int getBlue() const { return blue_; }
+    constexpr uint8_t getBlue() const { return blue_; }
+
+    /**
+     * @brief Gets the alpha (opacity) component.
+     * @return Alpha value (0=transparent, 255=opaque).
+     */
+    constexpr uint8_t getAlpha() const { return alpha_; }
+
+    /**
+     * @brief Gets the brightness of the color, i.e. its brightest channel (the HSV value).
+     * @return Brightness value (0-255).
+     */
+    constexpr uint8_t getBrightness() const {
+        const uint8_t redGreen = red_ > green_ ? red_ : green_;
+        return redGreen > blue_ ? redGreen : blue_;
+    }
 
     /**
     * @brief Scales the color's brightness using fast integer math.
@@ -53,115 +90,181 @@ public:
     * math and uses a fast bit-shift instead of a slow division.
     *
     * @param intensity The brightness factor (0=off, 255=full brightness).
-    * @return A new, scaled Color object.
+    * @return A new, scaled Color object. Alpha is preserved.
     */
-    Color scale(uint8_t intensity) const {
+    constexpr Color scale(uint8_t intensity) const {
         // The formula is (color * intensity) / 256.
         // Division by 256 is a simple bitwise right shift by 8.
         return Color(
-            (red_ * intensity) >> 8,
-            (green_ * intensity) >> 8,
-            (blue_ * intensity) >> 8
+            static_cast<uint8_t>((red_ * intensity) >> 8),
+            static_cast<uint8_t>((green_ * intensity) >> 8),
+            static_cast<uint8_t>((blue_ * intensity) >> 8),
+            alpha_
         );
     }
 
     /**
-     * @brief Generates a random color.
-     * @warning This implementation uses std::mt19937 which can be heavy
-     *          in terms of memory and performance for some microcontrollers.
-     *          Consider a simpler pseudo-random generator (like an LCG) for firmware.
+     * @brief Generates a random opaque color.
+     * @param rng The generator to draw from. The same seed yields the same colors.
      * @return A Color object with random RGB values.
      */
-    static Color randomColor() {
-        static std::mt19937 rng(std::random_device{}());
-        static std::uniform_int_distribution<int> dist(0, 255);
-        return Color(dist(rng), dist(rng), dist(rng));
+    static constexpr Color randomColor(Random& rng) {
+        const uint8_t red = rng.nextByte();
+        const uint8_t green = rng.nextByte();
+        const uint8_t blue = rng.nextByte();
+        return Color(red, green, blue);
     }
 
     /**
-     * @brief Lightens the color by a specified factor.
-     * @param factor Lightening factor (0.0f - 1.0f).
-     * @return A new Color with increased brightness.
+     * @brief Lightens the color towards white.
+     * @param amount Lightening factor in Q8 (0=unchanged, 255=white).
+     * @return A new Color with increased brightness. Alpha is preserved.
      */
-    Color lighten(float factor) const {
-        factor = std::clamp(factor, 0.0f, 1.0f);
+    constexpr Color lighten(uint8_t amount) const {
+        const int weight = toWeight(amount);
         return Color(
-            static_cast<int>(red_ + (255 - red_) * factor),
-            static_cast<int>(green_ + (255 - green_) * factor),
-            static_cast<int>(blue_ + (255 - blue_) * factor)
+            static_cast<uint8_t>(red_ + (((255 - red_) * weight) >> 8)),
+            static_cast<uint8_t>(green_ + (((255 - green_) * weight) >> 8)),
+            static_cast<uint8_t>(blue_ + (((255 - blue_) * weight) >> 8)),
+            alpha_
         );
     }
 
     /**
      * @brief Blends this color with another using weighted interpolation.
      * @param other The other Color to blend with.
-     * @param factor Interpolation factor (0.0f - 1.0f).
-     * @return A new Color resulting from the weighted blend.
+     * @param amount Interpolation factor in Q8 (0=this color, 255=the other color).
+     * @return A new Color resulting from the weighted blend, alpha included.
      */
-    Color blend(const Color& other, float factor) const {
-        factor = std::clamp(factor, 0.0f, 1.0f);
+    constexpr Color blend(const Color& other, uint8_t amount) const {
+        const int weight = toWeight(amount);
         return Color(
-            static_cast<int>(red_ + (other.red_ - red_) * factor),
-            static_cast<int>(green_ + (other.green_ - green_) * factor),
-            static_cast<int>(blue_ + (other.blue_ - blue_) * factor)
+            mix(red_, other.red_, weight),
+            mix(green_, other.green_, weight),
+            mix(blue_, other.blue_, weight),
+            mix(alpha_, other.alpha_, weight)
         );
     }
 
     /**
     * @brief Additively blends this color with another.
     *
-    * Each component is added together, clamping at 255. This is useful for
-    * layering light effects, where multiple lights make a surface brighter.
+    * Each component (alpha included) is added together, clamping at 255. This is
+    * useful for layering light effects, where multiple lights make a surface brighter.
     * @param other The color to add to this one.
     * @return A new Color representing the sum of both colors.
     */
-    Color add(const Color& other) const {
+    constexpr Color add(const Color& other) const {
+        return Color(
+            addSaturate(red_, other.red_),
+            addSaturate(green_, other.green_),
+            addSaturate(blue_, other.blue_),
+            addSaturate(alpha_, other.alpha_)
+        );
+    }
+
+    /**
+     * @brief Gets the color as one packed RGBA8 word: `R | G << 8 | B << 16 | A << 24`.
+     */
+    constexpr uint32_t toRGBA8() const {
+        return static_cast<uint32_t>(red_)
+            | static_cast<uint32_t>(green_) << 8
+            | static_cast<uint32_t>(blue_) << 16
+            | static_cast<uint32_t>(alpha_) << 24;
+    }
+
+    /**
+     * @brief Constructs a color from a packed RGBA8 word (see toRGBA8()).
+     */
+    static constexpr Color fromRGBA8(uint32_t packed) {
         return Color(
-            std::min(255, red_ + other.getRed()),
-            std::min(255, green_ + other.getGreen()),
-            std::min(255, blue_ + other.getBlue())
+            static_cast<uint8_t>(packed),
+            static_cast<uint8_t>(packed >> 8),
+            static_cast<uint8_t>(packed >> 16),
+            static_cast<uint8_t>(packed >> 24)
         );
     }
 
+    /**
+     * @brief Writes the color as a hexadecimal string ("#RRGGBB") into a fixed buffer.
+     *
+     * This version never allocates and is safe to use in firmware.
+     * @param out A buffer of at least 8 characters; it is NUL-terminated.
+     */
+    constexpr void toHex(char* out) const {
+        out[0] = '#';
+        writeHexByte(red_, out + 1);
+        writeHexByte(green_, out + 3);
+        writeHexByte(blue_, out + 5);
+        out[7] = '\0';
+    }
+
     /**
      * @brief Converts the color to a hexadecimal string ("#RRGGBB").
-     * @warning This function uses std::ostringstream, which relies on dynamic
-     *          memory allocation (heap). This should be avoided in firmware.
-     *          A safer alternative would use a fixed-size buffer and snprintf.
-     * @return String in hex format.
+     * @return String in hex format. Short enough to stay in the small-string buffer.
      */
     std::string toHex() const {
-        std::ostringstream oss;
-        oss << "#" << std::uppercase << std::setfill('0') << std::hex
-            << std::setw(2) << red_
-            << std::setw(2) << green_
-            << std::setw(2) << blue_;
-        return oss.str();
+        char buffer[8] = {};
+        toHex(buffer);
+        return std::string(buffer, 7);
     }
 
     /**
      * @brief Equality operator.
      */
-    bool operator==(const Color& other) const {
-        return red_ == other.red_ && green_ == other.green_ && blue_ == other.blue_;
+    constexpr bool operator==(const Color& other) const {
+        return toRGBA8() == other.toRGBA8();
     }
 
     /**
      * @brief Inequality operator.
      */
-    bool operator!=(const Color& other) const {
+    constexpr bool operator!=(const Color& other) const {
         return !(*this == other);
     }
 
 private:
-    int red_;
-    int green_;
-    int blue_;
+    // Byte order matters: it is the RGBA8 layout of a packed frame buffer.
+    uint8_t red_ = 0;
+    uint8_t green_ = 0;
+    uint8_t blue_ = 0;
+    uint8_t alpha_ = 255;
 
     /**
      * @brief Clamps a value between 0 and 255.
      */
-    static int clamp(int value) {
-        return std::max(0, std::min(255, value));
+    static constexpr uint8_t clamp(int value) {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    /**
+     * @brief Adds two components, clamping at 255.
+     */
+    static constexpr uint8_t addSaturate(uint8_t a, uint8_t b) {
+        const int sum = a + b;
+        return static_cast<uint8_t>(sum > 255 ? 255 : sum);
     }
-};
\ No newline at end of file
+
+    /**
+     * @brief Maps a Q8 factor (0-255) to a weight in 0-256, so that 255 means exactly 1.0.
+     */
+    static constexpr int toWeight(uint8_t amount) {
+        return amount + (amount >> 7);
+    }
+
+    /**
+     * @brief Interpolates between two components with a 0-256 weight.
+     */
+    static constexpr uint8_t mix(uint8_t from, uint8_t to, int weight) {
+        return static_cast<uint8_t>((from * (256 - weight) + to * weight) >> 8);
+    }
+
+    static constexpr void writeHexByte(uint8_t value, char* out) {
+        constexpr char DIGITS[] = "0123456789ABCDEF";
+        out[0] = DIGITS[value >> 4];
+        out[1] = DIGITS[value & 0x0F];
+    }
+};
+
+static_assert(sizeof(Color) == 4, "Color must stay a packed 4-byte RGBA8 value.");
+static_assert(std::is_trivially_copyable_v<Color>, "Color must be trivially copyable.");
@@ -0,0 +1,133 @@
+// include/util/ColorTables.h
+
+#pragma once
+#include "Core/Util/Color.h"
+#include <array>
+#include <cstdint>
+
+// Helpers used by the compiler to build the tables below. Never called at runtime.
+namespace ColorTablesDetail {
+
+using Table = std::array<uint8_t, 256>;
+
+/**
+ * @brief Fifth root of a value in [0, 1], by Newton's method (std::pow is not constexpr).
+ */
+constexpr double fifthRoot(double value) {
+    if (value <= 0.0) return 0.0;
+    double root = 1.0;
+    for (int i = 0; i < 64; ++i) {
+        const double r2 = root * root;
+        root -= (r2 * r2 * root - value) / (5.0 * r2 * r2);
+    }
+    return root;
+}
+
+/**
+ * @brief e^-x for x >= 0, by a Taylor series on x/16 squared four times (std::exp is not constexpr).
+ */
+constexpr double expNegative(double x) {
+    const double y = -x / 16.0;
+    double sum = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 16; ++n) {
+        term *= y / n;
+        sum += term;
+    }
+    for (int i = 0; i < 4; ++i) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+/**
+ * @brief Rounds a value in [0, 1] to the nearest 0-255 level.
+ */
+constexpr uint8_t toLevel(double value) {
+    const double scaled = value * 255.0 + 0.5;
+    return static_cast<uint8_t>(scaled >= 255.0 ? 255 : static_cast<int>(scaled));
+}
+
+constexpr Table makeGammaTable() {
+    Table table{};
+    for (int i = 0; i < 256; ++i) {
+        const double x = i / 255.0;
+        // x^2.2 = x^2 * x^(1/5)
+        table[i] = toLevel(x * x * fifthRoot(x));
+    }
+    return table;
+}
+
+constexpr Table makeLightnessTable() {
+    Table table{};
+    for (int i = 0; i < 256; ++i) {
+        const double lightness = i * 100.0 / 255.0; // CIE L* in 0-100
+        double luminance = 0.0;
+        if (lightness <= 8.0) {
+            luminance = lightness / 903.3;
+        }
+        else {
+            const double f = (lightness + 16.0) / 116.0;
+            luminance = f * f * f;
+        }
+        table[i] = toLevel(luminance);
+    }
+    return table;
+}
+
+constexpr Table makeFadeOutTable() {
+    constexpr double LN2 = 0.69314718055994531;
+    Table table{};
+    for (int i = 0; i < 256; ++i) {
+        // Halves five times over the fade: 255 at the start, 8 at the end.
+        table[i] = toLevel(expNegative(5.0 * LN2 * i / 256.0));
+    }
+    return table;
+}
+
+} // namespace ColorTablesDetail
+
+/**
+ * @class ColorTables
+ * @brief Compile-time lookup tables for gamma correction and perceptual brightness.
+ *
+ * LEDs respond linearly to their drive level, while the eye does not. These
+ * tables move that non-linear mapping out of the frame loop: they are computed
+ * entirely by the compiler and placed in read-only memory (flash on an MCU),
+ * so applying them at runtime is one byte load per channel, with no floating
+ * point.
+ *
+ * @author Michele Bisignano
+ */
+class ColorTables {
+public:
+    using Table = ColorTablesDetail::Table;
+
+    /**
+     * @brief Gamma 2.2 correction: maps a perceived level to an LED drive level.
+     */
+    static constexpr Table GAMMA_2_2 = ColorTablesDetail::makeGammaTable();
+
+    /**
+     * @brief CIE 1931 lightness curve: maps a perceived brightness (0-255) to a
+     *        linear drive level, so equal steps in input look like equal steps in light.
+     */
+    static constexpr Table PERCEPTUAL_BRIGHTNESS = ColorTablesDetail::makeLightnessTable();
+
+    /**
+     * @brief Exponential afterglow: maps how far a fade has progressed (0-255)
+     *        to a drive level, from 255 down to 8.
+     *
+     * The light halves at every fifth of the fade, like a cooling filament.
+     * Since the eye is roughly logarithmic, that reads as a steady, even fade
+     * rather than one that lingers at full brightness and then drops away.
+     */
+    static constexpr Table FADE_OUT = ColorTablesDetail::makeFadeOutTable();
+
+    /**
+     * @brief Applies a table to every color channel. Alpha is preserved.
+     */
+    static constexpr Color apply(const Table& table, const Color& color) {
+        return Color(table[color.getRed()], table[color.getGreen()], table[color.getBlue()], color.getAlpha());
+    }
+};
@@ -0,0 +1,113 @@
+// include/util/KeyBitset.h
+
+#pragma once
+#include "Core/Util/KeyMask.h"
+#include "Core/Util/Span.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class KeyBitset
+ * @brief A set of key indices stored as a packed bitmask in memory it does not own.
+ *
+ * The runtime-sized counterpart of KeyMask: bit i is the key with
+ * Key::getIndex() == i, and the words are a view into memory sized for the
+ * topology at hand (usually a StateBuffer), so an effect on a keyboard keeps
+ * two words per set and one on a 50,000-LED wall keeps 782. The operations
+ * and their cost are the same as KeyMask's: whole-set union and difference
+ * are word operations, and iteration uses count-trailing-zeros to visit only
+ * the keys that are present.
+ *
+ * @author Michele Bisignano
+ */
+class KeyBitset {
+public:
+    static constexpr size_t WORD_BITS = KeyMask::WORD_BITS;
+
+    /**
+     * @brief Gets the number of words a set of `keyCount` keys needs.
+     */
+    static constexpr size_t wordsFor(size_t keyCount) { return (keyCount + WORD_BITS - 1) / WORD_BITS; }
+
+    /**
+     * @brief Constructs an empty view, holding no key.
+     */
+    KeyBitset() = default;
+
+    /**
+     * @brief Constructs a set over `words`, which must outlive it. Their contents are kept.
+     */
+    explicit KeyBitset(Span<uint64_t> words) : words_(words) {}
+
+    void set(size_t index) { words_[index / WORD_BITS] |= bit(index); }
+    void reset(size_t index) { words_[index / WORD_BITS] &= ~bit(index); }
+    bool test(size_t index) const { return (words_[index / WORD_BITS] & bit(index)) != 0; }
+
+    /**
+     * @brief Removes every key from the set.
+     */
+    void clear() {
+        for (uint64_t& word : words_) word = 0;
+    }
+
+    /**
+     * @brief Checks whether at least one key is in the set.
+     */
+    bool any() const {
+        uint64_t acc = 0;
+        for (uint64_t word : words_) acc |= word;
+        return acc != 0;
+    }
+
+    /**
+     * @brief Gets the words of the set, e.g. to unite it with another one.
+     */
+    Span<const uint64_t> words() const { return Span<const uint64_t>(words_.data(), words_.size()); }
+
+    /**
+     * @brief Adds every key of another set of the same size (this |= other).
+     */
+    void unite(Span<const uint64_t> other) {
+        for (size_t w = 0; w < words_.size(); ++w) words_[w] |= other[w];
+    }
+
+    /**
+     * @brief Removes every key of another set of the same size (this &= ~other).
+     */
+    void subtract(Span<const uint64_t> other) {
+        for (size_t w = 0; w < words_.size(); ++w) words_[w] &= ~other[w];
+    }
+
+    /**
+     * @brief Calls `fn(index)` for every key in the set, in ascending index order.
+     */
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            forEachBit(words_[w], w, fn);
+        }
+    }
+
+    /**
+     * @brief Calls `fn(index)` for every key in either of two sets of the same size, in ascending order.
+     */
+    template<typename Fn>
+    static void forEachEither(const KeyBitset& a, const KeyBitset& b, Fn&& fn) {
+        for (size_t w = 0; w < a.words_.size(); ++w) {
+            forEachBit(a.words_[w] | b.words_[w], w, fn);
+        }
+    }
+
+private:
+    Span<uint64_t> words_;
+
+    static constexpr uint64_t bit(size_t index) { return uint64_t{ 1 } << (index % WORD_BITS); }
+
+    template<typename Fn>
+    static void forEachBit(uint64_t word, size_t w, Fn& fn) {
+        while (word != 0) {
+            fn(w * WORD_BITS + KeyMask::countTrailingZeros(word));
+            word &= word - 1; // Clear the lowest set bit.
+        }
+    }
+};
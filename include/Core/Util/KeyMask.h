@@ -0,0 +1,121 @@
+// include/util/KeyMask.h
+
+#pragma once
+#include "Core/Keyboard/KeyCodes.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @class KeyMask
+ * @brief A fixed-size set of key indices stored as a packed bitmask.
+ *
+ * Bit i corresponds to the key with Key::getIndex() == i. For a keyboard
+ * (MAX_KEYS below 128) the whole set fits in two 64-bit words, so union,
+ * intersection and difference of two sets are a handful of word operations
+ * regardless of how many keys they contain. Iteration over set bits uses count-trailing-zeros,
+ * so it only visits the keys that are actually present. Masks can be built at
+ * compile time, e.g. for constant neighbor tables.
+ *
+ * @author Michele Bisignano
+ */
+class KeyMask {
+public:
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t WORD_COUNT = (MAX_KEYS + WORD_BITS - 1) / WORD_BITS;
+
+    /**
+     * @brief Constructs an empty mask.
+     */
+    constexpr KeyMask() = default;
+
+    /**
+     * @brief Adds a key index to the set.
+     */
+    constexpr void set(size_t index) { words_[index / WORD_BITS] |= bit(index); }
+
+    /**
+     * @brief Removes a key index from the set.
+     */
+    constexpr void reset(size_t index) { words_[index / WORD_BITS] &= ~bit(index); }
+
+    /**
+     * @brief Checks whether a key index is in the set.
+     */
+    constexpr bool test(size_t index) const { return (words_[index / WORD_BITS] & bit(index)) != 0; }
+
+    /**
+     * @brief Removes every key from the set.
+     */
+    void clear() { words_.fill(0); }
+
+    /**
+     * @brief Checks whether at least one key is in the set.
+     */
+    constexpr bool any() const {
+        uint64_t acc = 0;
+        for (uint64_t word : words_) acc |= word;
+        return acc != 0;
+    }
+
+    /**
+     * @brief Returns the set with every key of `other` removed (this & ~other).
+     */
+    constexpr KeyMask without(const KeyMask& other) const {
+        KeyMask result;
+        for (size_t w = 0; w < WORD_COUNT; ++w) result.words_[w] = words_[w] & ~other.words_[w];
+        return result;
+    }
+
+    constexpr KeyMask& operator|=(const KeyMask& other) {
+        for (size_t w = 0; w < WORD_COUNT; ++w) words_[w] |= other.words_[w];
+        return *this;
+    }
+
+    constexpr KeyMask& operator&=(const KeyMask& other) {
+        for (size_t w = 0; w < WORD_COUNT; ++w) words_[w] &= other.words_[w];
+        return *this;
+    }
+
+    friend constexpr KeyMask operator|(KeyMask lhs, const KeyMask& rhs) { return lhs |= rhs; }
+    friend constexpr KeyMask operator&(KeyMask lhs, const KeyMask& rhs) { return lhs &= rhs; }
+
+    bool operator==(const KeyMask& other) const { return words_ == other.words_; }
+    bool operator!=(const KeyMask& other) const { return !(*this == other); }
+
+    /**
+     * @brief Calls `fn(index)` for every key in the set, in ascending index order.
+     */
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t w = 0; w < WORD_COUNT; ++w) {
+            uint64_t word = words_[w];
+            while (word != 0) {
+                fn(w * WORD_BITS + countTrailingZeros(word));
+                word &= word - 1; // Clear the lowest set bit.
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the index of the lowest set bit of a non-zero word.
+     */
+    static size_t countTrailingZeros(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<size_t>(index);
+#else
+        return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+    }
+
+private:
+    std::array<uint64_t, WORD_COUNT> words_{};
+
+    static constexpr uint64_t bit(size_t index) { return uint64_t{ 1 } << (index % WORD_BITS); }
+};
@@ -0,0 +1,81 @@
+// include/util/KeySet.h
+
+#pragma once
+#include "Core/Keyboard/KeyCodes.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class KeySet
+ * @brief A sparse set of key indices with O(1) insert and O(size) iteration.
+ *
+ * Membership is tracked in a packed bitmask, while the indices themselves are
+ * kept in insertion order. This lets a compositor record exactly which keys
+ * were touched during a frame and later visit only those keys, without
+ * scanning the whole keyboard. Both are sized for the topology once, at
+ * construction; inserting and clearing never allocate.
+ *
+ * @author Michele Bisignano
+ */
+class KeySet {
+public:
+    /**
+     * @brief Constructs an empty set for key indices below `capacity`.
+     * @param capacity The number of keys of the topology. One keyboard by default.
+     */
+    explicit KeySet(size_t capacity = MAX_KEYS)
+        : words_((capacity + WORD_BITS - 1) / WORD_BITS, 0),
+        indices_(capacity, 0)
+    {
+    }
+
+    /**
+     * @brief Adds a key index to the set. Inserting an index twice has no effect.
+     * @param index A key index, below capacity().
+     */
+    void insert(size_t index) {
+        assert(index < indices_.size() && "Key index out of range for the KeySet.");
+        uint64_t& word = words_[index / WORD_BITS];
+        if ((word & bit(index)) == 0) {
+            word |= bit(index);
+            indices_[size_++] = static_cast<uint16_t>(index);
+        }
+    }
+
+    /**
+     * @brief Checks whether a key index is in the set.
+     */
+    bool contains(size_t index) const { return (words_[index / WORD_BITS] & bit(index)) != 0; }
+
+    /**
+     * @brief Removes every index from the set, in O(size).
+     */
+    void clear() {
+        for (size_t i = 0; i < size_; ++i) {
+            words_[indices_[i] / WORD_BITS] = 0;
+        }
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Gets the number of keys the set was sized for.
+     */
+    size_t capacity() const { return indices_.size(); }
+
+    const uint16_t* begin() const { return indices_.data(); }
+    const uint16_t* end() const { return indices_.data() + size_; }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+
+    static constexpr uint64_t bit(size_t index) { return uint64_t{ 1 } << (index % WORD_BITS); }
+
+    std::vector<uint64_t> words_;
+    std::vector<uint16_t> indices_;
+    size_t size_ = 0;
+};
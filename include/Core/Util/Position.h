@@ -25,7 +25,7 @@ public:
      * @param y The vertical coordinate (must be >= 0.0f).
      * @throws InvalidPositionException if x or y are negative.
      */
-    Position(float x, float y) : x_(x), y_(y) {
+    constexpr Position(float x, float y) : x_(x), y_(y) {
         assert(x >= 0.0f && y >= 0.0f && "Position coordinates cannot be negative.");
     }
 
@@ -33,13 +33,13 @@ public:
      * @brief Gets the horizontal (x) coordinate.
      * @return The x value.
      */
-    float getX() const { return x_; }
+    constexpr float getX() const { return x_; }
 
     /**
      * @brief Gets the vertical (y) coordinate.
      * @return The y value.
      */
-    float getY() const { return y_; }
+    constexpr float getY() const { return y_; }
 
     /**
      * @brief Calculates the Euclidean (straight-line) distance to another position.
@@ -65,8 +65,11 @@ public:
      * @param other The other position to measure the distance to.
      * @return The Manhattan distance between the two points.
      */
-    float distanceManhattan(const Position& other) const {
-        return std::abs(other.x_ - x_) + std::abs(other.y_ - y_);
+    constexpr float distanceManhattan(const Position& other) const {
+        // std::abs is not constexpr before C++23, so the absolute values are taken by hand.
+        const float dx = other.x_ - x_;
+        const float dy = other.y_ - y_;
+        return (dx < 0.0f ? -dx : dx) + (dy < 0.0f ? -dy : dy);
     }
 
     /**
@@ -82,7 +85,7 @@ public:
     /**
      * @brief Equality operator.
      */
-    bool operator==(const Position& other) const {
+    constexpr bool operator==(const Position& other) const {
         // Direct comparison is generally acceptable for fixed key positions.
         return x_ == other.x_ && y_ == other.y_;
     }
@@ -90,7 +93,7 @@ public:
     /**
      * @brief Inequality operator.
      */
-    bool operator!=(const Position& other) const {
+    constexpr bool operator!=(const Position& other) const {
         return !(*this == other);
     }
 
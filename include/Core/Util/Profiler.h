@@ -0,0 +1,273 @@
+// include/util/Profiler.h
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+#include <thread>
+#endif
+
+/**
+ * @brief The hot-path stages timed by the profiler.
+ */
+enum class ProfileStage : uint8_t {
+    InputPoll,    // IInputSource::pollEvents().
+    EffectUpdate, // Advancing and retiring the active effects.
+    Composite,    // Blending the effects into the frame and diffing it.
+    Render,       // IHardware::renderChanges().
+    Count
+};
+
+/**
+ * @brief The loops paced by a FramePacer, whose pacing stats the profiler publishes.
+ */
+enum class PacedLoop : uint8_t {
+    Frame,      // The single-threaded (or replay) frame loop.
+    Input,      // The pipelined input thread.
+    Simulation, // The pipelined simulation thread.
+    Count
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief A lock-free histogram of durations with power-of-two buckets.
+ *
+ * Bucket b counts the durations of b significant bits, i.e. in [2^(b-1), 2^b)
+ * nanoseconds; the last bucket also takes everything longer. Recording is a
+ * few relaxed atomic operations, so one thread can record while another
+ * takes a snapshot. Percentiles read from a snapshot are bucket upper bounds,
+ * which is at most a factor of two off and plenty to spot a slow stage.
+ *
+ * @author Michele Bisignano
+ */
+class LatencyHistogram {
+public:
+    // 2^31 ns is about two seconds, far beyond any frame.
+    static constexpr size_t BUCKET_COUNT = 32;
+
+    /**
+     * @struct Snapshot
+     * @brief A plain copy of a histogram at one point in time.
+     */
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+
+        /**
+         * @brief Gets an upper bound of the given percentile (0..100), in nanoseconds.
+         */
+        uint64_t percentileNs(double percentile) const;
+    };
+
+    /**
+     * @brief Records one duration.
+     */
+    void record(uint64_t ns) {
+        buckets_[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+        totalNs_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = maxNs_.load(std::memory_order_relaxed);
+        while (ns > max && !maxNs_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Copies the current counts. Safe to call while another thread records.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Clears every count.
+     */
+    void reset();
+
+private:
+    static size_t bucketFor(uint64_t ns) {
+#if defined(__GNUC__) || defined(__clang__)
+        const size_t bits = ns == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(ns));
+#else
+        size_t bits = 0;
+        for (uint64_t rest = ns; rest != 0; rest >>= 1) {
+            ++bits;
+        }
+#endif
+        return bits < BUCKET_COUNT ? bits : BUCKET_COUNT - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> totalNs_{ 0 };
+    std::atomic<uint64_t> maxNs_{ 0 };
+};
+
+/**
+ * @class Profiler
+ * @brief Process-wide latency histograms of the hot-path stages, plus EffectPool
+ *        and FramePacer counters.
+ *
+ * The engine feeds it through the RIPPLEFX_PROFILE_* macros below, which
+ * compile to nothing unless RIPPLEFX_PROFILE is defined, so release and
+ * firmware builds carry no instrumentation at all. Every counter is an atomic
+ * written with relaxed ordering: a stage never waits for a reader, and dump()
+ * can run on any thread while the frame loop keeps going.
+ *
+ * @author Michele Bisignano
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Gets the process-wide profiler.
+     */
+    static Profiler& instance();
+
+    /**
+     * @brief Gets the histogram of one stage.
+     */
+    LatencyHistogram& stage(ProfileStage stage) {
+        return stages_[static_cast<size_t>(stage)];
+    }
+
+    /**
+     * @brief Publishes the EffectPool counters (see EffectPool::size() and friends).
+     */
+    void setPoolStats(size_t inUse, size_t capacity, size_t highWaterMark, uint64_t rejected) {
+        poolInUse_.store(inUse, std::memory_order_relaxed);
+        poolCapacity_.store(capacity, std::memory_order_relaxed);
+        poolHighWaterMark_.store(highWaterMark, std::memory_order_relaxed);
+        poolRejected_.store(rejected, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Publishes the stats of the FramePacer of one loop (see FramePacer::Stats).
+     */
+    void setPacerStats(PacedLoop loop, uint64_t frames, uint64_t missedDeadlines, uint64_t maxJitterNs) {
+        PacerCounters& counters = pacers_[static_cast<size_t>(loop)];
+        counters.frames.store(frames, std::memory_order_relaxed);
+        counters.missedDeadlines.store(missedDeadlines, std::memory_order_relaxed);
+        counters.maxJitterNs.store(maxJitterNs, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Writes a table of every stage, the pool counters and the pacer counters.
+     */
+    void dump(std::ostream& out) const;
+
+    /**
+     * @brief Clears every histogram. The pool and pacer counters are republished each frame.
+     */
+    void reset();
+
+private:
+    struct PacerCounters {
+        std::atomic<uint64_t> frames{ 0 };
+        std::atomic<uint64_t> missedDeadlines{ 0 };
+        std::atomic<uint64_t> maxJitterNs{ 0 };
+    };
+
+    Profiler() = default;
+
+    std::array<LatencyHistogram, static_cast<size_t>(ProfileStage::Count)> stages_;
+    std::atomic<size_t> poolInUse_{ 0 };
+    std::atomic<size_t> poolCapacity_{ 0 };
+    std::atomic<size_t> poolHighWaterMark_{ 0 };
+    std::atomic<uint64_t> poolRejected_{ 0 };
+    std::array<PacerCounters, static_cast<size_t>(PacedLoop::Count)> pacers_;
+};
+
+/**
+ * @class ScopedStageTimer
+ * @brief Records the lifetime of a scope in one stage's histogram.
+ *
+ * @author Michele Bisignano
+ */
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(ProfileStage stage) : stage_(stage), start_(Profiler::Clock::now()) {}
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+    ~ScopedStageTimer() {
+        const auto elapsed = Profiler::Clock::now() - start_;
+        Profiler::instance().stage(stage_).record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+private:
+    ProfileStage stage_;
+    Profiler::Clock::time_point start_;
+};
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+/**
+ * @class StatsReporter
+ * @brief Dumps the profiler from a background thread, periodically or on request.
+ *
+ * requestDump() only sets a lock-free flag, so it may be called from a signal
+ * handler (e.g. for SIGUSR1). The reporter thread checks the flag a few times
+ * per second and does the formatting and I/O itself, off the frame loop.
+ *
+ * @author Michele Bisignano
+ */
+class StatsReporter {
+public:
+    /**
+     * @brief Starts the reporter thread.
+     * @param out Where the stats are written. Must outlive the reporter.
+     * @param interval How often to dump unprompted, or zero to dump only on request.
+     */
+    StatsReporter(std::ostream& out, std::chrono::seconds interval);
+
+    StatsReporter(const StatsReporter&) = delete;
+    StatsReporter& operator=(const StatsReporter&) = delete;
+
+    /**
+     * @brief Stops and joins the reporter thread.
+     */
+    ~StatsReporter();
+
+    /**
+     * @brief Asks for a dump at the next check. Async-signal-safe.
+     */
+    void requestDump() { dumpRequested_.store(true, std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    std::ostream& out_;
+    const std::chrono::seconds interval_;
+    std::atomic<bool> dumpRequested_{ false };
+    std::atomic<bool> running_{ true };
+    std::thread thread_;
+};
+#endif
+
+// --- Instrumentation Macros ---
+#if defined(RIPPLEFX_PROFILE)
+#define RIPPLEFX_PROFILE_CONCAT_(a, b) a##b
+#define RIPPLEFX_PROFILE_CONCAT(a, b) RIPPLEFX_PROFILE_CONCAT_(a, b)
+
+// Times the rest of the enclosing scope as `stage`, a ProfileStage.
+#define RIPPLEFX_PROFILE_SCOPE(stage) \
+    ScopedStageTimer RIPPLEFX_PROFILE_CONCAT(profileScope_, __LINE__)(stage)
+
+// Publishes the counters of an EffectPool.
+#define RIPPLEFX_PROFILE_POOL(pool) \
+    Profiler::instance().setPoolStats((pool).size(), (pool).capacity(), (pool).highWaterMark(), (pool).rejectedCount())
+
+// Publishes the stats of the FramePacer `pacer` as those of `loop`, a PacedLoop.
+#define RIPPLEFX_PROFILE_PACER(loop, pacer) \
+    Profiler::instance().setPacerStats((loop), (pacer).getStats().frames, (pacer).getStats().missedDeadlines, \
+        static_cast<uint64_t>((pacer).getStats().maxJitter.count()))
+#else
+#define RIPPLEFX_PROFILE_SCOPE(stage) ((void)0)
+#define RIPPLEFX_PROFILE_POOL(pool) ((void)0)
+#define RIPPLEFX_PROFILE_PACER(loop, pacer) ((void)0)
+#endif
@@ -0,0 +1,43 @@
+// include/util/Random.h
+
+#pragma once
+#include <cstdint>
+
+/**
+ * @class Random
+ * @brief A tiny, seeded pseudo-random generator (xorshift32).
+ *
+ * The whole state is one 32-bit word and each draw is three shifts and three
+ * XORs, which suits microcontrollers far better than std::mt19937. Given the
+ * same seed it produces the same sequence on every platform, so a recorded
+ * session can be replayed with exactly the same colors.
+ *
+ * Not suitable for anything security-related.
+ *
+ * @author Michele Bisignano
+ */
+class Random {
+public:
+    /**
+     * @brief Constructs a generator. Every seed, including 0, is valid.
+     */
+    constexpr explicit Random(uint32_t seed) : state_(seed != 0 ? seed : 0x9E3779B9u) {}
+
+    /**
+     * @brief Draws the next 32-bit value.
+     */
+    constexpr uint32_t next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    /**
+     * @brief Draws the next value in [0, 255], from the best-mixed high bits.
+     */
+    constexpr uint8_t nextByte() { return static_cast<uint8_t>(next() >> 24); }
+
+private:
+    uint32_t state_;
+};
@@ -0,0 +1,130 @@
+// include/util/RealFft.h
+
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class RealFft
+ * @brief A fixed-size FFT of real input, with all its tables precomputed.
+ *
+ * The N real samples are packed into N/2 complex ones (even samples as the
+ * real parts, odd samples as the imaginary parts) and transformed with an
+ * iterative radix-2 FFT of half the size, then one split pass untangles the
+ * spectrum of the real signal. That is half the work of a complex FFT of N
+ * points.
+ *
+ * The constructor fills the twiddle table (the N/2 roots of unity used by
+ * both the FFT and the split pass), the bit-reversal permutation and a Hann
+ * window. After that, powerSpectrum() only reads those tables and writes into
+ * fixed member arrays: no allocation and no trigonometry per transform.
+ *
+ * @tparam N The number of real samples per transform. A power of two, at least 4.
+ *
+ * @author Michele Bisignano
+ */
+template<size_t N>
+class RealFft {
+    static_assert(N >= 4 && (N & (N - 1)) == 0, "N must be a power of two.");
+
+public:
+    // The number of complex points of the inner FFT.
+    static constexpr size_t HALF = N / 2;
+
+    // The number of frequency bins: 0 (DC) to N/2 (Nyquist), inclusive.
+    static constexpr size_t BINS = HALF + 1;
+
+    RealFft() {
+        constexpr double TWO_PI = 6.283185307179586;
+        for (size_t k = 0; k < HALF; ++k) {
+            // W^k = exp(-2*pi*i*k/N).
+            twiddleRe_[k] = static_cast<float>(std::cos(TWO_PI * static_cast<double>(k) / N));
+            twiddleIm_[k] = static_cast<float>(-std::sin(TWO_PI * static_cast<double>(k) / N));
+        }
+        for (size_t i = 0; i < N; ++i) {
+            window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(TWO_PI * static_cast<double>(i) / N));
+        }
+        size_t bits = 0;
+        while ((size_t{ 1 } << bits) < HALF) {
+            ++bits;
+        }
+        for (size_t i = 0; i < HALF; ++i) {
+            size_t reversed = 0;
+            for (size_t b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            bitReversed_[i] = static_cast<uint16_t>(reversed);
+        }
+    }
+
+    /**
+     * @brief Windows N samples and computes the power (squared magnitude) of every bin.
+     * @param samples The N input samples, oldest first.
+     * @param power Receives the BINS powers, from DC to Nyquist.
+     */
+    void powerSpectrum(const std::array<float, N>& samples, std::array<float, BINS>& power) {
+        // --- 1. PACK ---
+        // Windowed sample pairs, stored straight into bit-reversed order.
+        for (size_t i = 0; i < HALF; ++i) {
+            const size_t to = bitReversed_[i];
+            re_[to] = samples[2 * i] * window_[2 * i];
+            im_[to] = samples[2 * i + 1] * window_[2 * i + 1];
+        }
+
+        // --- 2. COMPLEX FFT OF N/2 POINTS ---
+        // A butterfly of span `length` uses W_length^j = W_N^(j * N / length),
+        // so every stage reads the one table with its own stride.
+        for (size_t length = 2; length <= HALF; length <<= 1) {
+            const size_t half = length / 2;
+            const size_t stride = N / length;
+            for (size_t start = 0; start < HALF; start += length) {
+                for (size_t j = 0; j < half; ++j) {
+                    const float wRe = twiddleRe_[j * stride];
+                    const float wIm = twiddleIm_[j * stride];
+                    const size_t a = start + j;
+                    const size_t b = a + half;
+                    const float vRe = re_[b] * wRe - im_[b] * wIm;
+                    const float vIm = re_[b] * wIm + im_[b] * wRe;
+                    re_[b] = re_[a] - vRe;
+                    im_[b] = im_[a] - vIm;
+                    re_[a] += vRe;
+                    im_[a] += vIm;
+                }
+            }
+        }
+
+        // --- 3. SPLIT ---
+        // With Z the packed transform, the even and odd halves of the signal are
+        // E[k] = (Z[k] + conj(Z[N/2-k])) / 2 and O[k] = (Z[k] - conj(Z[N/2-k])) / 2i,
+        // and X[k] = E[k] + W^k O[k].
+        power[0] = square(re_[0] + im_[0]);
+        power[HALF] = square(re_[0] - im_[0]);
+        for (size_t k = 1; k < HALF; ++k) {
+            const float zRe = re_[k];
+            const float zIm = im_[k];
+            const float cRe = re_[HALF - k];
+            const float cIm = -im_[HALF - k];
+            const float eRe = 0.5f * (zRe + cRe);
+            const float eIm = 0.5f * (zIm + cIm);
+            const float oRe = 0.5f * (zIm - cIm);
+            const float oIm = -0.5f * (zRe - cRe);
+            const float xRe = eRe + twiddleRe_[k] * oRe - twiddleIm_[k] * oIm;
+            const float xIm = eIm + twiddleRe_[k] * oIm + twiddleIm_[k] * oRe;
+            power[k] = xRe * xRe + xIm * xIm;
+        }
+    }
+
+private:
+    static float square(float value) { return value * value; }
+
+    std::array<float, HALF> twiddleRe_{};
+    std::array<float, HALF> twiddleIm_{};
+    std::array<float, N> window_{};
+    std::array<uint16_t, HALF> bitReversed_{};
+
+    // The working arrays of the inner FFT.
+    std::array<float, HALF> re_{};
+    std::array<float, HALF> im_{};
+};
@@ -0,0 +1,47 @@
+// include/util/Span.h
+
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class Span
+ * @brief A non-owning view over a contiguous sequence of objects.
+ *
+ * A minimal stand-in for C++20's std::span, so that batched APIs can accept a
+ * frame buffer or a key list without caring whether it lives in a std::vector,
+ * a std::array or a plain C array. A Span never allocates and is cheap to copy.
+ *
+ * @author Michele Bisignano
+ */
+template<typename T>
+class Span {
+public:
+    constexpr Span() = default;
+
+    /**
+     * @brief Constructs a view over `size` objects starting at `data`.
+     */
+    constexpr Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    /**
+     * @brief Constructs a view over any contiguous container exposing data() and size().
+     */
+    template<typename Container,
+        typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+    constexpr Span(Container& container) : data_(container.data()), size_(container.size()) {}
+
+    constexpr T* data() const { return data_; }
+    constexpr size_t size() const { return size_; }
+    constexpr bool empty() const { return size_ == 0; }
+
+    constexpr T& operator[](size_t index) const { return data_[index]; }
+
+    constexpr T* begin() const { return data_; }
+    constexpr T* end() const { return data_ + size_; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,136 @@
+// include/util/SpscQueue.h
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class SpscQueue
+ * @brief A fixed-capacity, lock-free single-producer, single-consumer ring buffer.
+ *
+ * One thread pushes and one thread pops (they may also be the same thread).
+ * Each side owns its own index and only reads the other's with an acquire
+ * load, and only when its cached copy says the ring looks full or empty, so
+ * in the common case a push or a pop touches no shared cache line at all.
+ *
+ * The storage is a plain array sized at compile time: the queue never
+ * allocates, and a full queue simply rejects the push.
+ *
+ * @tparam T A trivially copyable element type.
+ * @tparam Capacity The number of slots. Must be a power of two.
+ *
+ * @author Michele Bisignano
+ */
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief The number of elements the queue can hold.
+     */
+    static constexpr size_t capacity() { return Capacity; }
+
+    // --- Producer side ---
+
+    /**
+     * @brief Appends an element. Never blocks.
+     * @return true if the element was queued, false if the queue is full.
+     */
+    bool tryPush(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == Capacity) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == Capacity) {
+                return false;
+            }
+        }
+        slots_[tail & MASK] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Appends as many elements of a block as there is room for, in order. Never blocks.
+     *
+     * The whole block is published with one release store, so streaming data
+     * (e.g. audio samples) costs one synchronization per block, not per element.
+     * @return The number of elements queued, from the front of the block.
+     */
+    size_t tryPushSome(const T* values, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (Capacity - (tail - cachedHead_) < count) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+        }
+        const size_t pushed = std::min(count, Capacity - (tail - cachedHead_));
+        for (size_t i = 0; i < pushed; ++i) {
+            slots_[(tail + i) & MASK] = values[i];
+        }
+        tail_.store(tail + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    // --- Consumer side ---
+
+    /**
+     * @brief Removes the oldest element. Never blocks.
+     * @param value Receives the element, if there is one.
+     * @return true if an element was removed, false if the queue is empty.
+     */
+    bool tryPop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return false;
+            }
+        }
+        value = slots_[head & MASK];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes up to `count` of the oldest elements, in order. Never blocks.
+     * @return The number of elements removed.
+     */
+    size_t tryPopSome(T* values, size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (cachedTail_ - head < count) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t popped = std::min(count, cachedTail_ - head);
+        for (size_t i = 0; i < popped; ++i) {
+            values[i] = slots_[(head + i) & MASK];
+        }
+        head_.store(head + popped, std::memory_order_release);
+        return popped;
+    }
+
+    /**
+     * @brief Checks whether the queue is empty. Exact only on the consumer side.
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    std::array<T, Capacity> slots_{};
+
+    // The indices grow forever and are masked on access; size_t wrap-around
+    // keeps `tail - head` correct. Each side's index and its cached copy of the
+    // other side's index share a cache line that the other side never writes.
+    alignas(64) std::atomic<size_t> head_{ 0 }; // Written by the consumer.
+    size_t cachedTail_ = 0; // Consumer only.
+    alignas(64) std::atomic<size_t> tail_{ 0 }; // Written by the producer.
+    size_t cachedHead_ = 0; // Producer only.
+};
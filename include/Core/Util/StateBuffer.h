@@ -0,0 +1,74 @@
+// include/util/StateBuffer.h
+
+#pragma once
+#include "Core/Util/Span.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+/**
+ * @class StateBuffer
+ * @brief Hands out the per-key arrays of an effect from one block of memory sized for its topology.
+ *
+ * Effects whose state grows with the number of keys (a fade phase per key, a
+ * wave per key, ...) report the bytes they need for a given topology with a
+ * static `stateSize(const Topology&)`, and their constructor carves their
+ * arrays out of a StateBuffer of that size with take(). The EffectPool places
+ * the buffer right behind the effect in the same slot, so an effect on a
+ * keyboard is as small as the keyboard, one on an LED wall as large as the
+ * wall, and creating either allocates nothing.
+ *
+ * The buffer only hands out memory; it never frees or destroys anything, so
+ * it only holds trivially destructible types.
+ *
+ * @author Michele Bisignano
+ */
+class StateBuffer {
+public:
+    // The alignment of every array; enough for any type with fundamental alignment.
+    static constexpr size_t ALIGN = alignof(std::max_align_t);
+
+    /**
+     * @brief Gets the bytes take<T>(count) uses, a multiple of ALIGN.
+     */
+    template<typename T>
+    static constexpr size_t sizeFor(size_t count) {
+        return (count * sizeof(T) + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    /**
+     * @brief Constructs an empty buffer, from which only empty arrays can be taken.
+     */
+    StateBuffer() = default;
+
+    /**
+     * @brief Constructs a buffer over `size` bytes at `data`, aligned to ALIGN, which must outlive it.
+     */
+    StateBuffer(void* data, size_t size) : data_(static_cast<std::byte*>(data)), size_(size) {}
+
+    /**
+     * @brief Takes the next `count` objects of type T, value-initialized (zero for arithmetic types).
+     * @return A view of the objects. The buffer must have sizeFor<T>(count) bytes left.
+     */
+    template<typename T>
+    Span<T> take(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "A StateBuffer never destroys what it holds.");
+        static_assert(alignof(T) <= ALIGN, "Type is over-aligned for a StateBuffer.");
+
+        const size_t bytes = sizeFor<T>(count);
+        assert(bytes <= size_ - used_ && "StateBuffer too small: stateSize() and the constructor disagree.");
+        T* items = reinterpret_cast<T*>(data_ + used_);
+        for (size_t i = 0; i < count; ++i) {
+            new (items + i) T();
+        }
+        used_ += bytes;
+        return Span<T>(items, count);
+    }
+
+private:
+    std::byte* data_ = nullptr;
+    size_t size_ = 0;
+    size_t used_ = 0;
+};
@@ -0,0 +1,96 @@
+// include/util/TripleBuffer.h
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * @brief A lock-free single-producer, single-consumer handoff of the latest value.
+ *
+ * Three copies of T rotate between the producer and the consumer. The producer
+ * always owns the "back" copy and the consumer always owns the "front" copy,
+ * so both work without waiting for each other. The third, "middle", copy is
+ * swapped with a single atomic exchange:
+ * - publish() hands the freshly written back copy over and takes the middle one;
+ * - acquire() takes the middle copy if it is newer than the front one.
+ *
+ * Neither side ever blocks. If the producer publishes faster than the consumer
+ * acquires, intermediate values are skipped and the consumer always gets the
+ * newest complete one, which is exactly what a display wants.
+ *
+ * All three copies are created up front, so reusing them (e.g. assigning a
+ * frame of the same size) allocates nothing.
+ *
+ * @author Michele Bisignano
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    /**
+     * @brief Constructs the buffer with three copies of `initial`.
+     */
+    explicit TripleBuffer(const T& initial) : buffers_{ { initial, initial, initial } } {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // --- Producer side ---
+
+    /**
+     * @brief Gets the copy the producer writes the next value into.
+     */
+    T& writeBuffer() { return buffers_[back_]; }
+
+    /**
+     * @brief Publishes the write buffer as the newest value. Never blocks.
+     */
+    void publish() {
+        // Release makes the writes to the back copy visible to the consumer that
+        // picks it up; acquire makes sure the copy we get back is no longer read.
+        const uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH_BIT), std::memory_order_acq_rel);
+        back_ = static_cast<uint8_t>(previous & INDEX_MASK);
+    }
+
+    // --- Consumer side ---
+
+    /**
+     * @brief Checks whether a value newer than the read buffer has been published.
+     */
+    bool hasNew() const {
+        return (middle_.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+    /**
+     * @brief Makes the newest published value the read buffer, if there is one. Never blocks.
+     * @return true if the read buffer changed, false if nothing new was published.
+     */
+    bool acquire() {
+        if (!hasNew()) {
+            return false;
+        }
+        const uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = static_cast<uint8_t>(previous & INDEX_MASK);
+        return true;
+    }
+
+    /**
+     * @brief Gets the value the consumer reads, as of the last successful acquire().
+     */
+    const T& readBuffer() const { return buffers_[front_]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    std::array<T, 3> buffers_{};
+
+    // Each index lives on its own cache line, so the two threads never contend
+    // on anything but the middle index itself.
+    alignas(64) uint8_t back_ = 0; // Producer only.
+    alignas(64) std::atomic<uint8_t> middle_{ 1 }; // Shared: buffer index plus FRESH_BIT.
+    alignas(64) uint8_t front_ = 2; // Consumer only.
+};
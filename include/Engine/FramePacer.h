@@ -0,0 +1,104 @@
+#pragma once
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @class FramePacer
+ * @brief Wakes its caller at a fixed frame rate, precisely and without burning a core.
+ *
+ * Deadlines are absolute: each one is the previous deadline plus the frame
+ * period, so sleep overshoot never accumulates into drift. wait() sleeps until
+ * shortly before the deadline (with `clock_nanosleep(TIMER_ABSTIME)` on Linux)
+ * and spins only for the last stretch, which the OS timer cannot hit reliably.
+ *
+ * When the caller falls behind by more than a whole frame, the missed frames
+ * are counted and the schedule restarts from now, instead of running a burst
+ * of back-to-back frames to catch up.
+ *
+ * Not available in RIPPLEFX_SINGLE_THREADED (firmware) builds, which pace
+ * their loop with the platform's own timer.
+ *
+ * @author Michele Bisignano
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Pacing statistics since construction or the last resetStats().
+     */
+    struct Stats {
+        uint64_t frames = 0; // Calls to wait().
+        uint64_t missedDeadlines = 0; // Deadlines that had already passed when wait() was called.
+        std::chrono::nanoseconds maxJitter{ 0 }; // Worst wake-up time after a deadline that was met.
+    };
+
+    /**
+     * @brief Constructs the pacer. The first deadline is one period from now.
+     * @param targetFps The frame rate to pace to. Must be positive.
+     */
+    explicit FramePacer(int targetFps);
+
+    /**
+     * @brief Constructs the pacer from a frame period instead of a frame rate.
+     */
+    explicit FramePacer(std::chrono::nanoseconds period);
+
+    /**
+     * @brief Changes the frame rate. The schedule restarts from now.
+     */
+    void setTargetFps(int targetFps);
+
+    /**
+     * @brief Gets the frame period.
+     */
+    std::chrono::nanoseconds getPeriod() const { return period_; }
+
+    /**
+     * @brief Sets how long before each deadline wait() stops sleeping and starts spinning.
+     *
+     * Longer is more precise on coarse OS timers but costs more CPU per frame.
+     * Zero disables spinning entirely.
+     */
+    void setSpinThreshold(std::chrono::nanoseconds threshold) { spinThreshold_ = threshold; }
+
+    /**
+     * @brief Blocks until the next frame's deadline.
+     */
+    void wait();
+
+    /**
+     * @brief Restarts the schedule, e.g. after the caller slept through an idle period.
+     *
+     * The next wait() returns at once and the following deadlines are counted
+     * from there, so the time spent idle is not counted as missed deadlines.
+     */
+    void resync();
+
+    /**
+     * @brief Gets the pacing statistics.
+     */
+    const Stats& getStats() const { return stats_; }
+
+    /**
+     * @brief Clears the pacing statistics.
+     */
+    void resetStats() { stats_ = Stats{}; }
+
+private:
+    /**
+     * @brief Sleeps until `deadline` using the most precise absolute sleep available.
+     */
+    static void sleepUntil(Clock::time_point deadline);
+
+    std::chrono::nanoseconds period_;
+    std::chrono::nanoseconds spinThreshold_;
+    Clock::time_point deadline_;
+    bool resynced_ = false;
+    Stats stats_;
+};
+
+#endif
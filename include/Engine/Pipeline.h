@@ -0,0 +1,184 @@
+#pragma once
+#include "Core/Input/IInputSource.h"
+#include "Core/Input/KeyEvent.h"
+#include "Core/Keyboard/Topology.h"
+#include "Core/Lighting/LightingManager.h"
+#include "Core/Lighting/RippleSpawner.h"
+#include "Core/Util/Color.h"
+#include "Core/Util/KeySet.h"
+#include "Core/Util/TripleBuffer.h"
+#include "Hardware/IHardware.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+#include "Engine/FramePacer.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @class Pipeline
+ * @brief Runs the input -> simulation -> output loop, on one thread or on three.
+ *
+ * The pipeline can be driven in two ways:
+ * - Single-threaded: the caller invokes runFrame() once per frame, which polls
+ *   the input source, updates the LightingManager and renders, in that order.
+ *   This is the only mode on firmware builds (define RIPPLEFX_SINGLE_THREADED).
+ * - Pipelined: start() spawns one thread per stage. Key events flow from the
+ *   input stage to the simulation stage through a lock-free KeyEventQueue, and
+ *   finished frames from the simulation stage to the output stage through a
+ *   lock-free TripleBuffer. No
+ *   stage ever waits for another: a slow device call only makes the output
+ *   stage skip to the newest complete frame, while input and simulation keep
+ *   their own pace.
+ *
+ * Each thread is paced by its own FramePacer. When the pipeline goes idle (no
+ * active effect and no pending input) the simulation thread blocks until a key
+ * event arrives, and the input thread blocks in the source's waitForEvents(),
+ * or polls it at IDLE_POLL_INTERVAL_MS if it cannot wait. The output thread
+ * wakes every IDLE_WAIT_TIMEOUT_MS to pass the unchanged frame to
+ * renderChanges(), as the single-threaded loop does, so a backend's keep-alive
+ * still runs.
+ *
+ * In pipelined mode the output stage may skip frames, so it tracks the frame
+ * it last sent itself and computes the changed keys against it, instead of
+ * using the LightingManager's per-frame dirty set. The input source and the
+ * hardware backend must allow pollEvents() and renderChanges() to run on
+ * different threads.
+ *
+ * @author Michele Bisignano
+ */
+class Pipeline {
+public:
+    /**
+     * @brief Constructs the pipeline. All references must outlive it.
+     * @param topology The keyboard (or LED topology) the frames are rendered for.
+     * @param input The source of key events.
+     * @param hardware The device the frames are sent to.
+     * @param lightingManager The simulation, driven by the pipeline.
+     * @param spawner Turns key presses into effects.
+     * @param frameDuration The simulation period (and the input polling period).
+     */
+    Pipeline(const Topology& topology, IInputSource& input, IHardware& hardware, LightingManager& lightingManager,
+        RippleSpawner& spawner, std::chrono::nanoseconds frameDuration);
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    ~Pipeline();
+
+    /**
+     * @brief Single-threaded mode: polls input, updates the simulation and renders one frame.
+     * @param timestampMs The current time in milliseconds, for sources that cannot timestamp events.
+     */
+    void runFrame(uint32_t timestampMs);
+
+    /**
+     * @brief Single-threaded mode: checks whether running frames would change nothing.
+     *
+     * True when no effect is active, the last frame was black and no key event
+     * is pending. The caller can then block in waitForInput() instead.
+     */
+    bool isIdle() const;
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+    /**
+     * @brief How often an idle pipeline polls input sources that cannot be waited on.
+     */
+    static constexpr uint32_t IDLE_POLL_INTERVAL_MS = 10;
+
+    /**
+     * @brief The longest an idle thread blocks in IInputSource::waitForEvents(),
+     *        which bounds how long stop() may take, and the longest the idle
+     *        output thread goes without calling IHardware::renderChanges().
+     */
+    static constexpr uint32_t IDLE_WAIT_TIMEOUT_MS = 100;
+
+    /**
+     * @brief Single-threaded mode: blocks until input may be available.
+     *
+     * Sleeps in the source's waitForEvents() for up to IDLE_WAIT_TIMEOUT_MS,
+     * or for IDLE_POLL_INTERVAL_MS if the source can only be polled (or its
+     * stream has ended).
+     * @return true if it actually blocked (for IDLE_POLL_INTERVAL_MS or longer),
+     *         so the caller's FramePacer should be resynced. A wait that returned
+     *         at once leaves the schedule intact, so the next FramePacer::wait()
+     *         still sleeps and an idle loop can never spin.
+     */
+    bool waitForInput();
+
+    /**
+     * @brief Pipelined mode: starts the input, simulation and output threads.
+     *
+     * runFrame() must not be called while the pipeline is running.
+     */
+    void start();
+
+    /**
+     * @brief Stops and joins the pipeline threads. Safe to call when not running.
+     */
+    void stop();
+
+    /**
+     * @brief Checks whether the pipeline threads are running.
+     */
+    bool isRunning() const;
+#endif
+
+private:
+    /**
+     * @brief Drains the event queue, starting a ripple for every key press.
+     */
+    void handleKeyEvents();
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+    void inputStage();
+    void simulationStage();
+    void outputStage();
+
+    /**
+     * @brief Milliseconds since the pipeline started, for sources that cannot timestamp events.
+     */
+    uint32_t elapsedMs() const;
+#endif
+
+    const Topology& topology_;
+    IInputSource& input_;
+    IHardware& hardware_;
+    LightingManager& lightingManager_;
+    RippleSpawner& spawner_;
+    const std::chrono::nanoseconds frameDuration_;
+
+    // Input -> simulation. Filled by whoever polls the input source and drained by
+    // whoever runs the simulation (the caller, or the input and simulation threads).
+    KeyEventQueue events_;
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+    TripleBuffer<std::vector<Color>> frames_; // Simulation -> output.
+
+    // Owned by the output thread.
+    std::vector<Color> sentFrame_;
+    KeySet changedKeys_;
+
+    std::chrono::steady_clock::time_point startTime_;
+    std::atomic<bool> running_{ false };
+    std::atomic<bool> idle_{ false }; // Set by the simulation thread while it sleeps.
+
+    // Let the output thread sleep until a frame is published, and the idle
+    // simulation thread until a key event is queued. Notifiers take the mutex
+    // for an empty critical section only, which orders the notification after
+    // the waiter's predicate check, so no wakeup is lost.
+    std::mutex frameReadyMutex_;
+    std::condition_variable frameReady_;
+    std::mutex inputReadyMutex_;
+    std::condition_variable inputReady_;
+
+    std::thread inputThread_;
+    std::thread simulationThread_;
+    std::thread outputThread_;
+#endif
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#if !defined(_WIN32)
+
+#include "Hardware/IHardware.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+/**
+ * @class DmxOutput
+ * @brief An IHardware that mirrors the keyboard onto stage lighting over E1.31 (sACN) or Art-Net.
+ *
+ * A patch maps keys to DMX universes and channels: every entry drives three
+ * consecutive channels (red, green, blue) from one key, and a key may appear
+ * in any number of entries, e.g. to drive several fixtures. One UDP packet
+ * buffer per universe is built in initialize(), with its headers already
+ * filled in; rendering a frame only writes channel values into those buffers.
+ *
+ * Only universes whose channels changed are sent, plus a keep-alive copy of the
+ * others every KEEPALIVE_INTERVAL, so receivers do not time out on universes
+ * whose keys hold still. On Linux all the packets of a frame go out with a single
+ * sendmmsg() call; other POSIX systems fall back to one sendto() per packet.
+ * Nothing is allocated after initialize().
+ *
+ * By default sACN packets go to each universe's multicast group
+ * (239.255.hi.lo) on port 5568 and Art-Net packets to port 6454 of the given
+ * address. Pass a host such as 127.0.0.1 and a port of your choice to test
+ * against a local receiver.
+ *
+ * Not available on Windows.
+ *
+ * @author Michele Bisignano
+ */
+class DmxOutput : public IHardware {
+public:
+    /**
+     * @brief The wire protocol.
+     */
+    enum class Protocol {
+        Sacn,  // ANSI E1.31, "streaming ACN".
+        ArtNet // Art-Net 4 ArtDmx.
+    };
+
+    /**
+     * @struct Patch
+     * @brief Drives channels `channel`..`channel + 2` of `universe` with the color of key `keyIndex`.
+     */
+    struct Patch {
+        uint16_t keyIndex;
+        uint16_t universe; // 1..63999 for sACN, 0..32767 for Art-Net.
+        uint16_t channel;  // 1-based, at most 510.
+    };
+
+    /**
+     * @brief Transfer statistics since initialize().
+     */
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t packets = 0;
+        uint64_t unchangedSkipped = 0; // Universes not sent because nothing changed.
+        uint64_t sendCalls = 0; // System calls made to send packets.
+        uint64_t sendErrors = 0; // Packets the socket refused.
+    };
+
+    static constexpr uint16_t SACN_PORT = 5568;
+    static constexpr uint16_t ARTNET_PORT = 6454;
+    static constexpr size_t CHANNELS_PER_UNIVERSE = 512;
+    static constexpr size_t KEYS_PER_UNIVERSE = CHANNELS_PER_UNIVERSE / 3;
+
+    // E1.31 receivers give up on a source after 2.5 s without packets.
+    static constexpr std::chrono::milliseconds KEEPALIVE_INTERVAL{ 1000 };
+
+    /**
+     * @brief Builds a patch that lays `copies` copies of the keyboard out on
+     *        consecutive channels, KEYS_PER_UNIVERSE keys per universe.
+     */
+    static std::vector<Patch> linearPatch(size_t keyCount, uint16_t firstUniverse, size_t copies = 1);
+
+    /**
+     * @brief Constructs the backend. Nothing is opened until initialize().
+     * @param protocol sACN or Art-Net.
+     * @param patch Which key drives which channels.
+     * @param host The IPv4 address to send to, or nullptr for sACN multicast.
+     * @param port The UDP port, or 0 for the protocol's standard port.
+     */
+    DmxOutput(Protocol protocol, std::vector<Patch> patch, const char* host = nullptr, uint16_t port = 0);
+
+    DmxOutput(const DmxOutput&) = delete;
+    DmxOutput& operator=(const DmxOutput&) = delete;
+
+    ~DmxOutput() override;
+
+    bool initialize() override;
+    void shutdown() override;
+    void render(const std::vector<Color>& frameBuffer) override;
+
+    /**
+     * @brief Writes the changed keys' universes, and sends whatever changed or is due for keep-alive.
+     */
+    void renderChanges(const std::vector<Color>& frameBuffer, const KeySet& dirtyKeys) override;
+
+    /**
+     * @brief Stage lighting has no keys; always reports none.
+     */
+    void getKeyboardState(KeyMask& pressed) const override;
+
+    /**
+     * @brief Gets the number of universes in the patch.
+     */
+    size_t getUniverseCount() const { return universes_.size(); }
+
+    /**
+     * @brief Gets the transfer statistics.
+     */
+    const Stats& getStats() const { return stats_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @struct Universe
+     * @brief One universe's packet, its destination and its send state.
+     */
+    struct Universe {
+        uint16_t number = 0;
+        uint8_t sequence = 0;
+        bool changed = true; // Send on the next frame; true at first so receivers get a full state.
+        Clock::time_point lastSent;
+        std::vector<uint8_t> packet;
+        sockaddr_in address{};
+    };
+
+    /**
+     * @struct Slot
+     * @brief A resolved patch entry: where a key's three channel bytes live.
+     */
+    struct Slot {
+        uint16_t keyIndex;
+        uint16_t universe; // Index into universes_.
+        uint32_t offset;   // Byte offset of the red channel in the universe's packet.
+    };
+
+    void buildPacket(Universe& universe) const;
+
+    /**
+     * @brief Copies the patched keys' colors into the packets, flagging universes that changed.
+     */
+    void writeFrame(const std::vector<Color>& frameBuffer);
+
+    /**
+     * @brief Sends every changed universe and every universe due for keep-alive, in one batch.
+     */
+    void sendDue();
+
+    const Protocol protocol_;
+    const std::vector<Patch> patch_;
+    const std::string host_; // Empty for sACN multicast.
+    const uint16_t port_;
+
+    int socket_ = -1;
+    uint8_t cid_[16] = {}; // The sACN component identifier, fixed for the session.
+    std::vector<Universe> universes_;
+    std::vector<Slot> slots_;
+
+    // The batch of a frame, built from preallocated storage.
+    std::vector<size_t> dueUniverses_;
+    std::vector<iovec> iovecs_;
+#if defined(__linux__)
+    std::vector<mmsghdr> messages_;
+#endif
+    Stats stats_;
+};
+
+#endif
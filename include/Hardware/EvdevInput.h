@@ -0,0 +1,87 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include "Core/Input/IInputSource.h"
+#include "Core/Keyboard/Keyboard.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <linux/input.h>
+
+/**
+ * @class EvdevInput
+ * @brief An IInputSource that reads Linux evdev `input_event` records.
+ *
+ * The source reads from any file descriptor that carries raw `struct input_event`
+ * records: a device node such as `/dev/input/event3` (which usually needs root
+ * or the `input` group), a FIFO, or a file recorded with
+ * `cat /dev/input/event3 > keys.bin`, which makes input reproducible for testing.
+ *
+ * Reads are non-blocking. Every event keeps the kernel's own timestamp, so a
+ * tap between two polls is neither lost nor mistimed. Auto-repeat events and
+ * keys that are not part of the layout are ignored. The stream is closed at
+ * the end of a recording or when a FIFO's writer hangs up, so an idle engine
+ * never spins on a stream that will not deliver again. A FIFO may be opened
+ * before its writer connects.
+ *
+ * Only available on Linux.
+ *
+ * @author Michele Bisignano
+ */
+class EvdevInput : public IInputSource {
+public:
+    /**
+     * @brief Opens an evdev stream.
+     * @param keyboard The layout used to map Linux key codes to key indices. Must outlive the source.
+     * @param path The device node, FIFO or recording to read from.
+     */
+    EvdevInput(const Keyboard& keyboard, const char* path);
+
+    EvdevInput(const EvdevInput&) = delete;
+    EvdevInput& operator=(const EvdevInput&) = delete;
+
+    ~EvdevInput() override;
+
+    /**
+     * @brief Checks whether the stream was opened successfully.
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    void pollEvents(KeyEventQueue& events, uint32_t nowMs) override;
+
+    /**
+     * @brief Sleeps in poll(2) until the stream is readable or the timeout expires.
+     * @return false once the stream has ended (end of a recording, or the FIFO's
+     *         writer hung up), so the caller falls back to a timed sleep.
+     */
+    bool waitForEvents(uint32_t timeoutMs) override;
+
+private:
+    static constexpr size_t LINUX_KEY_LIMIT = 128; // All keyboard keys have Linux codes below this.
+    static constexpr uint16_t NO_KEY = 0xFFFF;
+    static constexpr size_t BUFFER_EVENTS = 64;
+
+    /**
+     * @brief Queues the events held in the buffer, keeping the ones that do not fit.
+     * @return false if the queue filled up.
+     */
+    bool drainBuffer(KeyEventQueue& events);
+
+    /**
+     * @brief Closes the stream at its end, or after an error.
+     */
+    void closeStream();
+
+    int fd_ = -1;
+    bool endsAtEof_ = false; // A regular file (a recording): a read of 0 bytes is its end.
+    std::array<uint16_t, LINUX_KEY_LIMIT> indexByLinuxCode_{};
+
+    // Raw bytes read from the stream. Records may arrive split across reads
+    // (from a pipe), so a trailing partial record is kept for the next read.
+    std::array<unsigned char, BUFFER_EVENTS * sizeof(input_event)> buffer_{};
+    size_t bufferBegin_ = 0;
+    size_t bufferEnd_ = 0;
+};
+
+#endif
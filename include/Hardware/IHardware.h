@@ -2,6 +2,8 @@
 
 #include "Core/Keyboard/KeyCodes.h"
 #include "Core/Util/Color.h"
+#include "Core/Util/KeyMask.h"
+#include "Core/Util/KeySet.h"
 #include <vector>
 
 /**
@@ -39,9 +41,30 @@ public:
     virtual void render(const std::vector<Color>& frameBuffer) = 0;
 
     /**
-     * @brief Gets the current state of every key on the keyboard.
-     * @return A vector of booleans, where the index corresponds to a key's index
-     *         in the Keyboard layout. 'true' means the key is currently held down.
+     * @brief Sends a frame to the hardware, given which keys changed since the previous one.
+     *
+     * The default implementation performs a full render() when at least one key
+     * changed and does nothing otherwise, so an idle keyboard costs no device calls.
+     * Backends that can address individual keys may override it to send only
+     * the changed ones. While the keyboard is idle it is still called with an
+     * empty set at least every Pipeline::IDLE_WAIT_TIMEOUT_MS, so backends
+     * that must refresh the device periodically can do it here.
+     * @param frameBuffer A vector of Colors representing the state of every key.
+     * @param dirtyKeys The indices of the keys whose color changed.
+     */
+    virtual void renderChanges(const std::vector<Color>& frameBuffer, const KeySet& dirtyKeys) {
+        if (!dirtyKeys.empty()) {
+            render(frameBuffer);
+        }
+    }
+
+    /**
+     * @brief Takes a snapshot of which keys are currently held down.
+     *
+     * This is the input path for devices that can only be polled; wrap the
+     * hardware in a PolledInput to turn the snapshots into key events.
+     * @param pressed Receives the set of held keys, by index in the Keyboard layout.
+     *        It is overwritten entirely, so it can be reused across calls.
      */
-    virtual std::vector<bool> getKeyboardState() const = 0;
+    virtual void getKeyboardState(KeyMask& pressed) const = 0;
 };
\ No newline at end of file
@@ -25,7 +25,7 @@ public:
     bool initialize() override;
     void shutdown() override;
     void render(const std::vector<Color>& frameBuffer) override;
-    std::vector<bool> getKeyboardState() const override;
+    void getKeyboardState(KeyMask& pressed) const override;
 
 private:
     const Keyboard* keyboard_;
@@ -0,0 +1,74 @@
+#pragma once
+
+#if !defined(_WIN32)
+
+#include "Core/Input/PcmRing.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @class PcmInput
+ * @brief Streams raw PCM audio from a file, FIFO or stdin into a PcmRing, on a thread of its own.
+ *
+ * The stream is headerless, signed 16-bit little-endian mono, at the rate
+ * given to the constructor, e.g. what `arecord -f S16_LE -c 1 -r 44100 -t raw`
+ * or `ffmpeg -i song.mp3 -f s16le -ac 1 -ar 44100 -` write. No audio hardware
+ * or library is needed, so a recording plays back the same way on any machine.
+ *
+ * The reader thread pushes samples into the ring in blocks of BLOCK_SAMPLES
+ * as soon as they arrive. Pipes, FIFOs and stdin are read as fast as their
+ * writer delivers, so they must be produced in real time; a regular file is
+ * played at its sample rate instead, with the thread sleeping between blocks.
+ * The ring is closed at the end of the stream.
+ *
+ * Not available on Windows.
+ *
+ * @author Michele Bisignano
+ */
+class PcmInput {
+public:
+    // Samples per block: 1.5 ms at 44.1 kHz, a small part of a frame.
+    static constexpr size_t BLOCK_SAMPLES = 64;
+
+    /**
+     * @brief Opens a stream and starts reading it.
+     * @param path The file or FIFO to read, or "-" for stdin.
+     * @param sampleRate The sample rate of the stream, in Hz.
+     */
+    PcmInput(const char* path, uint32_t sampleRate);
+
+    PcmInput(const PcmInput&) = delete;
+    PcmInput& operator=(const PcmInput&) = delete;
+
+    /**
+     * @brief Stops the reader thread and closes the stream.
+     */
+    ~PcmInput();
+
+    /**
+     * @brief Checks whether the stream was opened successfully.
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Gets the ring the samples are pushed into.
+     */
+    PcmRing& getRing() { return ring_; }
+
+private:
+    // How often a reader waiting for data checks whether it should stop.
+    static constexpr int STOP_CHECK_INTERVAL_MS = 50;
+
+    void run();
+
+    PcmRing ring_;
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    bool paced_ = false; // A regular file, read at the sample rate.
+    std::atomic<bool> running_{ true };
+    std::thread thread_;
+};
+
+#endif
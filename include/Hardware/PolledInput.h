@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Core/Input/IInputSource.h"
+#include "Core/Util/KeyMask.h"
+#include "Hardware/IHardware.h"
+
+/**
+ * @class PolledInput
+ * @brief An IInputSource for hardware that can only report which keys are held.
+ *
+ * Every poll takes a KeyMask snapshot from the hardware and compares it with
+ * the previous one: keys that appeared become Press events and keys that
+ * disappeared become Release events, all stamped with the poll time. The
+ * comparison is a few word operations and nothing is allocated.
+ *
+ * @author Michele Bisignano
+ */
+class PolledInput : public IInputSource {
+public:
+    /**
+     * @brief Constructs the source.
+     * @param hardware The device to poll. Must outlive the source.
+     */
+    explicit PolledInput(const IHardware& hardware);
+
+    void pollEvents(KeyEventQueue& events, uint32_t nowMs) override;
+
+private:
+    const IHardware& hardware_;
+    KeyMask current_;
+    KeyMask previous_; // The keys reported as held so far, through queued events.
+};
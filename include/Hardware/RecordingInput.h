@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Core/Input/IInputSource.h"
+#include "Core/Input/KeyTrace.h"
+#include <cstdio>
+
+/**
+ * @class RecordingInput
+ * @brief An IInputSource that records another source's events to a trace file.
+ *
+ * Events pass through unchanged. Each one is appended to the file in the
+ * KeyTrace format, together with the index of the poll that delivered it and
+ * the session's color seed, so ReplayInput can later reproduce the session
+ * frame for frame. The file is flushed after every poll that recorded events.
+ *
+ * @author Michele Bisignano
+ */
+class RecordingInput : public IInputSource {
+public:
+    /**
+     * @brief Creates (or truncates) the trace file.
+     * @param source The source to record. Must outlive the recorder.
+     * @param path The trace file to write.
+     * @param seed The color seed the session runs with (see RippleSpawner).
+     */
+    RecordingInput(IInputSource& source, const char* path, uint32_t seed);
+
+    RecordingInput(const RecordingInput&) = delete;
+    RecordingInput& operator=(const RecordingInput&) = delete;
+
+    ~RecordingInput() override;
+
+    /**
+     * @brief Checks whether the trace file was created successfully.
+     */
+    bool isOpen() const { return file_ != nullptr; }
+
+    void pollEvents(KeyEventQueue& events, uint32_t nowMs) override;
+    bool waitForEvents(uint32_t timeoutMs) override { return source_.waitForEvents(timeoutMs); }
+
+private:
+    void flush();
+
+    IInputSource& source_;
+    std::FILE* file_;
+    KeyTraceWriter writer_;
+    KeyEventQueue staged_; // Events from the source, not yet forwarded.
+    KeyEvent pending_; // An event that did not fit in the caller's queue.
+    bool hasPending_ = false;
+    uint32_t pollIndex_ = 0;
+};
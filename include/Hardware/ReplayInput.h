@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Core/Input/IInputSource.h"
+#include "Core/Input/KeyTrace.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ReplayInput
+ * @brief An IInputSource that plays back a trace written by RecordingInput.
+ *
+ * Every event is delivered by the same poll, counted from the first, that
+ * delivered it while recording, and with its recorded timestamp. Driving the
+ * engine one frame per poll (Pipeline::runFrame()) with a RippleSpawner seeded
+ * from getSeed() therefore reproduces the recorded frames exactly, on any
+ * machine and at any speed: a trace is a reproducible benchmark workload.
+ *
+ * The whole trace is loaded at construction; playback never touches the disk.
+ *
+ * @author Michele Bisignano
+ */
+class ReplayInput : public IInputSource {
+public:
+    /**
+     * @brief Loads a trace file.
+     * @param path The trace to replay.
+     */
+    explicit ReplayInput(const char* path);
+
+    ReplayInput(const ReplayInput&) = delete;
+    ReplayInput& operator=(const ReplayInput&) = delete;
+
+    /**
+     * @brief Checks whether the file was read and has a valid trace header.
+     */
+    bool isOpen() const { return open_; }
+
+    /**
+     * @brief Gets the color seed of the recorded session.
+     */
+    uint32_t getSeed() const { return reader_.getSeed(); }
+
+    /**
+     * @brief Checks whether every event of the trace has been delivered.
+     */
+    bool isFinished() const { return !hasNext_; }
+
+    void pollEvents(KeyEventQueue& events, uint32_t nowMs) override;
+
+    /**
+     * @brief Never blocks: the next recorded event is always due on a later poll.
+     */
+    bool waitForEvents(uint32_t /*timeoutMs*/) override { return true; }
+
+private:
+    std::vector<uint8_t> bytes_; // Declared before reader_, which views it.
+    KeyTraceReader reader_;
+    bool open_;
+    bool hasNext_ = false;
+    uint32_t nextPollIndex_ = 0;
+    KeyEvent next_;
+    uint32_t pollIndex_ = 0;
+};
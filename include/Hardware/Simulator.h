@@ -2,31 +2,88 @@
 
 #include "Core/Keyboard/Keyboard.h" // Needed to map framebuffer indices to Key IDs
 #include "Hardware/IHardware.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 /**
  * @class Simulator
  * @brief An IHardware implementation that simulates a keyboard in the console.
  *
  * This class is used for testing and development. It "renders" the keyboard's
- * lighting state by printing color values to the console and simulates key
- * presses at a fixed interval.
- * 
+ * lighting state to the console and simulates key presses at a fixed interval.
+ * Two output modes are available:
+ * - Mode::Log prints the color of every changed key as a line of text.
+ * - Mode::Ansi draws the keyboard as a grid of 24-bit-color cells, laid out
+ *   from each key's position. Only the cells whose color changed since the
+ *   previous frame are redrawn, and the whole frame is sent with a single
+ *   write() from a buffer allocated once, so it keeps up with hundreds of
+ *   frames per second in a terminal.
+ *
  * @author Michele Bisignano
  */
 class Simulator : public IHardware {
 public:
+    /**
+     * @brief How the Simulator shows frames.
+     */
+    enum class Mode {
+        Log, // One text line per changed key.
+        Ansi // A live, colored keyboard grid (needs a terminal with 24-bit color).
+    };
+
     /**
      * @brief Constructs the Simulator.
      * @param keyboard A pointer to the keyboard model to map colors to key IDs for printing.
+     * @param mode How frames are shown.
      */
-    explicit Simulator(const Keyboard* keyboard);
+    explicit Simulator(const Keyboard* keyboard, Mode mode = Mode::Log);
 
     bool initialize() override;
     void shutdown() override;
     void render(const std::vector<Color>& frameBuffer) override;
-    std::vector<bool> getKeyboardState() const override;
+
+    /**
+     * @brief Shows only the keys that changed, and nothing at all for an unchanged frame.
+     */
+    void renderChanges(const std::vector<Color>& frameBuffer, const KeySet& dirtyKeys) override;
+    void getKeyboardState(KeyMask& pressed) const override;
 
 private:
+    /**
+     * @struct Cell
+     * @brief Where a key is drawn in the ANSI grid (1-based terminal coordinates).
+     */
+    struct Cell {
+        uint16_t row;
+        uint16_t column;
+    };
+
+    /**
+     * @brief Lays the keys out as terminal cells and sizes the output buffer.
+     */
+    void buildAnsiGrid();
+
+    /**
+     * @brief Appends the escape sequences that paint key `index` in `color`.
+     */
+    char* appendCell(char* out, size_t index, const Color& color);
+
+    /**
+     * @brief Sends the bytes of `ansiBuffer_` up to `end` to the terminal in one write.
+     */
+    void flushAnsi(const char* end);
+
     const Keyboard* keyboard_;
-    mutable int frameCount_ = 0;
-};
\ No newline at end of file
+    Mode mode_;
+    // Atomic because a pipelined engine polls and renders from different threads.
+    mutable std::atomic<int> frameCount_{ 0 };
+
+    // --- Ansi mode ---
+    std::vector<Cell> cells_; // One per key, indexed like the frame buffer.
+    std::vector<Color> shownColors_; // What each cell currently shows on screen.
+    std::vector<char> ansiBuffer_; // Large enough for a frame that redraws every cell.
+    uint16_t gridRows_ = 0;
+    Color lastCellColor_; // The background set by the last painted cell, within a frame.
+};
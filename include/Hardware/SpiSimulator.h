@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Core/Output/LedEncoder.h"
+#include "Hardware/IHardware.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SpiSimulator
+ * @brief An IHardware that stands in for an addressable LED strip on an SPI bus.
+ *
+ * Sending a frame copies the LedEncoder's buffer, as a DMA transfer would,
+ * and then checks every byte of the copy against the frame it is supposed to
+ * show: the header, the trailer and each key's pixel, re-encoded independently
+ * at the key's position. The encoder is expected to be kept up to date by a
+ * LightingManager (see LightingManager::setLedEncoder()), so this verifies
+ * that updating only the changed keys never leaves a stale pixel behind.
+ *
+ * shutdown() prints the frames and bytes sent, the verification errors, and
+ * how long the transfers would take on the wire at the configured SPI clock.
+ * An LED strip has no keys, so getKeyboardState() always reports none; feed
+ * the engine from another input source (e.g. a replay).
+ *
+ * @author Michele Bisignano
+ */
+class SpiSimulator : public IHardware {
+public:
+    // A common clock for APA102 strips and small SPI displays.
+    static constexpr uint32_t DEFAULT_CLOCK_HZ = 8000000;
+
+    /**
+     * @brief Transfer statistics since initialize().
+     */
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t mismatchedBytes = 0; // Bytes that did not match the frame they were sent for.
+    };
+
+    /**
+     * @brief Constructs the simulator.
+     * @param encoder The encoder whose buffer is sent. Must outlive the simulator.
+     * @param clockHz The simulated SPI clock, used to report the time on the wire.
+     */
+    explicit SpiSimulator(const LedEncoder& encoder, uint32_t clockHz = DEFAULT_CLOCK_HZ);
+
+    bool initialize() override;
+    void shutdown() override;
+    void render(const std::vector<Color>& frameBuffer) override;
+    void getKeyboardState(KeyMask& pressed) const override;
+
+    /**
+     * @brief Gets the transfer statistics.
+     */
+    const Stats& getStats() const { return stats_; }
+
+private:
+    /**
+     * @brief Counts the bytes of the last transfer that differ from what `frameBuffer` should produce.
+     */
+    uint64_t verify(const std::vector<Color>& frameBuffer) const;
+
+    const LedEncoder& encoder_;
+    const uint32_t clockHz_;
+    std::vector<uint8_t> wire_; // The bytes of the last transfer, as the strip received them.
+    Stats stats_;
+};
@@ -2,80 +2,79 @@
  * @author Michele Bisignano
  */
 #include "Core/Effects/RippleEffect.h"
-#include "Core/Keyboard/KeyCodes.h"
+#include <algorithm>
 
-RippleEffect::RippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime)
-    : color_(color),
-    stepDuration_(stepDuration > 0 ? stepDuration : 1),
-    propagationDelay_(propagationDelay > 0 ? propagationDelay : 1),
+size_t RippleEffect::stateSize(const Topology& topology) {
+    const size_t keyCount = topology.getKeys().size();
+    return 2 * StateBuffer::sizeFor<uint64_t>(KeyBitset::wordsFor(keyCount)) + StateBuffer::sizeFor<uint16_t>(keyCount);
+}
+
+RippleEffect::RippleEffect(const Topology& topology, StateBuffer state, const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime)
+    : topology_(&topology),
+    lit_(state.take<uint64_t>(KeyBitset::wordsFor(topology.getKeys().size()))),
+    spread_(state.take<uint64_t>(KeyBitset::wordsFor(topology.getKeys().size()))),
+    fadePhase_(state.take<uint16_t>(topology.getKeys().size())),
+    color_(color),
+    phaseStep_(fadePhaseStep(clampStepDuration(stepDuration))),
+    // A crest key spreads once it has been lit for propagationDelay frames,
+    // and only during its first step: a longer delay never spreads.
+    spreadFrom_(static_cast<uint32_t>(std::min(std::max(propagationDelay, 1), clampStepDuration(stepDuration))) * phaseStep_),
+    spreadUntil_(static_cast<uint32_t>(clampStepDuration(stepDuration)) * phaseStep_),
+    fadeEnd_(static_cast<uint32_t>(FADE_STEPS * clampStepDuration(stepDuration)) * phaseStep_),
     maxLifetime_(maxLifetime)
 {
-    // We can pre-allocate memory in the hash table to improve performance.
-    // 104 is the max number of keys, so this is a safe upper bound.
-    activeKeys_.reserve(static_cast<size_t>(KeyCode::KEY_COUNT));
-    activeKeys_[&startKey] = { State::Ignited, 0 };
+    // Every key starts out unlit; only the origin is part of the ripple.
+    lit_.set(startKey.getIndex());
 }
 
 
 void RippleEffect::update() {
     framesLived_++;
     if (isFinished()) {
-        activeKeys_.clear();
+        lit_.forEach([&](size_t i) { fadePhase_[i] = 0; });
+        lit_.clear();
         return;
     }
 
-    // This map will store the complete state of the effect for the *next* frame.
-    std::unordered_map<const Key*, KeyState> next_frame_states;
-    next_frame_states.reserve(activeKeys_.size() + 10);
-
-    // --- Single Pass Update Logic ---
-    // Iterate through all keys that are currently active in the effect.
-    for (auto const& [key, current_state] : activeKeys_) {
+    // All decisions below are taken against the keys lit in the *current*
+    // frame, which gives the same result as building a separate next-frame
+    // state and swapping it in.
 
-        // --- 1. PROPAGATE ---
-        // If this key is at the crest of the wave, it should ignite its neighbors.
-        if (current_state.state == State::Ignited && current_state.framesInState >= propagationDelay_) {
-            for (const Key* neighbor : key->neighbors) {
-                // We only ignite a neighbor if it's not already in the *next* frame's map.
-                // This prevents a key from being ignited and then immediately overwritten by a
-                // different state transition in the same frame.
-                if (activeKeys_.find(neighbor) == activeKeys_.end()) {
-                    next_frame_states[neighbor] = { State::Ignited, 0 };
-                }
+    // --- 1. PROPAGATE ---
+    // Every key at the crest of the wave contributes its whole neighborhood:
+    // one OR of its neighbor mask where the topology has them, or a walk of
+    // its contiguous neighbor list otherwise.
+    spread_.clear();
+    const bool useMasks = topology_->hasNeighborMasks();
+    lit_.forEach([&](size_t i) {
+        if (fadePhase_[i] >= spreadFrom_ && fadePhase_[i] < spreadUntil_) {
+            if (useMasks) {
+                spread_.unite(topology_->getNeighborMask(i));
             }
-        }
-
-        // --- 2. TRANSITION ---
-        // Now, calculate the next state for the key we are currently processing.
-        KeyState next_state = current_state;
-        next_state.framesInState++;
-
-        if (next_state.framesInState >= stepDuration_) {
-            next_state.framesInState = 0; // Reset counter for the new state
-
-            if (current_state.state == State::Ignited) {
-                next_state.state = State::Fading_High;
-            }
-            else if (current_state.state == State::Fading_High) {
-                next_state.state = State::Fading_Low;
-            }
-            else { // The state was Fading_Low
-                // The key's life is over. We remove it from the effect by simply
-                // NOT adding it to the next_frame_states map.
-                continue; // Skip to the next key in the for loop
+            else {
+                topology_->forEachNeighbor(i, [&](size_t neighbor) { spread_.set(neighbor); });
             }
         }
+    });
+    // We only ignite neighbors that are not already lit, so a fading key is
+    // never pulled back to full brightness by the wave behind it.
+    spread_.subtract(lit_.words());
 
-        // --- 3. UPDATE ---
-        // Place the key's calculated next state into the map for the next frame.
-        // This will correctly overwrite any newly ignited neighbors if they were
-        // somehow already part of the activeKeys_ map (which shouldn't happen
-        // with correct propagation, but this makes the logic safer).
-        next_frame_states[key] = next_state;
-    }
+    // --- 2. FADE ---
+    // Advance every lit key's phase and drop the ones whose fade is over.
+    // Phases are exact multiples of phaseStep_, so they reach fadeEnd_ exactly
+    // and never overflow.
+    lit_.forEach([&](size_t i) {
+        fadePhase_[i] = static_cast<uint16_t>(fadePhase_[i] + phaseStep_);
+        if (fadePhase_[i] >= fadeEnd_) {
+            fadePhase_[i] = 0; // Ready for a later re-ignition.
+            lit_.reset(i);
+        }
+    });
 
-    // Atomically update the effect's state for the next frame.
-    activeKeys_ = next_frame_states;
+    // --- 3. UPDATE ---
+    // Newly ignited keys were unlit, so their phases are already 0.
+    lit_.unite(spread_.words());
 }
 
 Color RippleEffect::getColorForKey(const Key& key) const {
@@ -84,23 +83,37 @@ Color RippleEffect::getColorForKey(const Key& key) const {
         return Color(0, 0, 0);
     }
 
-    auto it = activeKeys_.find(&key);
-    if (it == activeKeys_.end()) {
-        // This key is not currently affected by this ripple.
-        return Color(0, 0, 0);
+    const size_t index = key.getIndex();
+    if (lit_.test(index)) {
+        return fadeColor(color_, fadePhase_[index]);
     }
+    // This key is not currently affected by this ripple.
+    return Color(0, 0, 0);
+}
 
-    // Return a color based on the key's current state.
-    switch (it->second.state) {
-    case State::Ignited:
-        return color_;
-    case State::Fading_High:
-        return color_.scale(204); // ~80%
-    case State::Fading_Low:
-        return color_.scale(102); // ~40%
-    default:
-        return Color(0, 0, 0);
+void RippleEffect::composite(Span<const Key> /*keys*/, Span<Color> frame, KeySet& touched) const {
+    if (isFinished()) {
+        return;
     }
+
+    // Only lit keys are ever visited, and each costs the same whatever its fade level.
+    lit_.forEach([&](size_t i) {
+        frame[i] = frame[i].add(fadeColor(color_, fadePhase_[i]));
+        touched.insert(i);
+    });
+}
+
+uint8_t RippleEffect::getIntensity() const {
+    if (isFinished() || !lit_.any()) {
+        return 0;
+    }
+
+    // The youngest lit key is the brightest one.
+    uint16_t youngest = 0xFFFF;
+    lit_.forEach([&](size_t i) {
+        youngest = std::min(youngest, fadePhase_[i]);
+    });
+    return fadeColor(color_, youngest).getBrightness();
 }
 
 bool RippleEffect::isFinished() const {
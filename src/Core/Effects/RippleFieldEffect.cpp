@@ -0,0 +1,150 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Effects/RippleFieldEffect.h"
+#include <algorithm>
+
+namespace {
+
+// Compares wave numbers by their difference, so the order survives a wrap of the counter.
+bool isNewer(uint32_t generation, uint32_t than) {
+    return static_cast<int32_t>(generation - than) > 0;
+}
+
+} // namespace
+
+size_t RippleFieldEffect::stateSize(const Topology& topology) {
+    const size_t keyCount = topology.getKeys().size();
+    return 3 * StateBuffer::sizeFor<Wave>(keyCount) + 3 * StateBuffer::sizeFor<uint64_t>(KeyBitset::wordsFor(keyCount));
+}
+
+RippleFieldEffect::RippleFieldEffect(const Topology& topology, StateBuffer state)
+    : topology_(&topology),
+    carried_(state.take<Wave>(topology.getKeys().size())),
+    carriedLit_(state.take<uint64_t>(KeyBitset::wordsFor(topology.getKeys().size()))),
+    underneath_(state.take<Wave>(topology.getKeys().size())),
+    underneathLit_(state.take<uint64_t>(KeyBitset::wordsFor(topology.getKeys().size()))),
+    arriving_(state.take<Wave>(topology.getKeys().size())),
+    arrivals_(state.take<uint64_t>(KeyBitset::wordsFor(topology.getKeys().size())))
+{
+}
+
+void RippleFieldEffect::addSource(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime) {
+    // The same timing a RippleEffect derives from these parameters.
+    const int step = RippleEffect::clampStepDuration(stepDuration);
+    const int delay = std::min(std::max(propagationDelay, 1), step);
+
+    Wave wave;
+    wave.color = color;
+    wave.generation = nextGeneration_++;
+    wave.endFrame = frame_ + static_cast<uint32_t>(std::max(maxLifetime, 0));
+    wave.phaseStep = RippleEffect::fadePhaseStep(step);
+    wave.spreadFrom = static_cast<uint16_t>(delay * wave.phaseStep);
+    wave.spreadUntil = static_cast<uint16_t>(step * wave.phaseStep);
+    ignite(startKey.getIndex(), wave);
+}
+
+void RippleFieldEffect::update() {
+    frame_++;
+
+    // --- 1. PROPAGATE ---
+    // Every crest key offers its wave to its neighbors. A neighbor takes the
+    // newest wave offered to it, if that is newer than the one it carries.
+    // Only the current frame's state is read, as in RippleEffect.
+    carriedLit_.forEach([&](size_t i) {
+        const Wave& wave = carried_[i];
+        if (wave.phase < wave.spreadFrom || wave.phase >= wave.spreadUntil || hasEnded(wave)) {
+            return;
+        }
+        topology_->forEachNeighbor(i, [&](size_t neighbor) {
+            if (!isNewer(wave.generation, carried_[neighbor].generation)) {
+                return;
+            }
+            if (arrivals_.test(neighbor) && !isNewer(wave.generation, arriving_[neighbor].generation)) {
+                return;
+            }
+            arriving_[neighbor] = wave;
+            arriving_[neighbor].phase = 0;
+            arrivals_.set(neighbor);
+        });
+    });
+
+    // --- 2. FADE ---
+    advance(carried_, carriedLit_);
+    advance(underneath_, underneathLit_);
+
+    // --- 3. IGNITE ---
+    arrivals_.forEach([&](size_t i) {
+        ignite(i, arriving_[i]);
+    });
+    arrivals_.clear();
+}
+
+Color RippleFieldEffect::getColorForKey(const Key& key) const {
+    const size_t index = key.getIndex();
+    Color color(0, 0, 0);
+    if (carriedLit_.test(index)) {
+        color = colorOf(carried_[index]);
+    }
+    if (underneathLit_.test(index)) {
+        color = color.add(colorOf(underneath_[index]));
+    }
+    return color;
+}
+
+void RippleFieldEffect::composite(Span<const Key> /*keys*/, Span<Color> frame, KeySet& touched) const {
+    // Each lit key is visited once, whatever the number of waves.
+    KeyBitset::forEachEither(carriedLit_, underneathLit_, [&](size_t i) {
+        Color color(0, 0, 0);
+        if (carriedLit_.test(i)) {
+            color = colorOf(carried_[i]);
+        }
+        if (underneathLit_.test(i)) {
+            color = color.add(colorOf(underneath_[i]));
+        }
+        frame[i] = frame[i].add(color);
+        touched.insert(i);
+    });
+}
+
+bool RippleFieldEffect::isFinished() const {
+    return !carriedLit_.any() && !underneathLit_.any();
+}
+
+uint8_t RippleFieldEffect::getIntensity() const {
+    uint8_t brightest = 0;
+    KeyBitset::forEachEither(carriedLit_, underneathLit_, [&](size_t i) {
+        brightest = std::max(brightest, getColorForKey(topology_->getKeys()[i]).getBrightness());
+    });
+    return brightest;
+}
+
+bool RippleFieldEffect::hasEnded(const Wave& wave) const {
+    return static_cast<int32_t>(frame_ - wave.endFrame) >= 0;
+}
+
+void RippleFieldEffect::ignite(size_t index, const Wave& wave) {
+    // The displaced wave keeps fading underneath, unless a brighter one is already there.
+    if (carriedLit_.test(index)) {
+        const Wave& displaced = carried_[index];
+        if (!underneathLit_.test(index) || displaced.phase < underneath_[index].phase) {
+            underneath_[index] = displaced;
+            underneathLit_.set(index);
+        }
+    }
+    carried_[index] = wave;
+    carriedLit_.set(index);
+}
+
+void RippleFieldEffect::advance(Span<Wave> waves, KeyBitset& lit) {
+    // Phases are exact multiples of the wave's step, so they reach the end of
+    // the fade exactly and never overflow.
+    lit.forEach([&](size_t i) {
+        Wave& wave = waves[i];
+        wave.phase = static_cast<uint16_t>(wave.phase + wave.phaseStep);
+        if (wave.phase >= RippleEffect::FADE_STEPS * wave.spreadUntil || hasEnded(wave)) {
+            wave.phase = 0;
+            lit.reset(i);
+        }
+    });
+}
@@ -0,0 +1,99 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Effects/SeekableRippleEffect.h"
+#include <algorithm>
+
+SeekableRippleEffect::SeekableRippleEffect(const Topology& topology, const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime)
+    : topology_(&topology),
+    startIndex_(startKey.getIndex()),
+    color_(color),
+    stepDuration_(RippleEffect::clampStepDuration(stepDuration)),
+    phaseStep_(RippleEffect::fadePhaseStep(stepDuration_)),
+    // A crest key ignites its neighbors once it has been lit for propagationDelay
+    // frames; they show up one frame later.
+    ringInterval_((propagationDelay > 0 ? propagationDelay : 1) + 1),
+    // The crest only lasts stepDuration frames, so a longer delay never spreads.
+    propagates_((propagationDelay > 0 ? propagationDelay : 1) < stepDuration_),
+    maxLifetime_(maxLifetime)
+{
+    // The farthest ring the wave can reach, for getIntensity().
+    if (propagates_) {
+        for (uint8_t hops : topology.getHopDistances(startIndex_)) {
+            if (hops != Topology::UNREACHABLE_HOPS && hops > farthestHops_) {
+                farthestHops_ = hops;
+            }
+        }
+    }
+}
+
+void SeekableRippleEffect::update() {
+    framesLived_++;
+}
+
+Color SeekableRippleEffect::getColorForKey(const Key& key) const {
+    return getColorAt(key, framesLived_);
+}
+
+Color SeekableRippleEffect::getColorAt(const Key& key, int frame) const {
+    if (frame < 0 || frame >= maxLifetime_) {
+        return Color(0, 0, 0);
+    }
+    return colorForHops(topology_->getHopDistance(startIndex_, key.getIndex()), frame);
+}
+
+void SeekableRippleEffect::composite(Span<const Key> /*keys*/, Span<Color> frame, KeySet& touched) const {
+    if (isFinished()) {
+        return;
+    }
+
+    const Span<const uint8_t> hops = topology_->getHopDistances(startIndex_);
+    const Color black(0, 0, 0);
+    for (size_t i = 0; i < hops.size(); ++i) {
+        const Color color = colorForHops(hops[i], framesLived_);
+        if (color != black) {
+            frame[i] = frame[i].add(color);
+            touched.insert(i);
+        }
+    }
+}
+
+uint8_t SeekableRippleEffect::getIntensity() const {
+    if (isFinished()) {
+        return 0;
+    }
+
+    // The youngest ring that exists is the brightest one.
+    const int youngestRing = std::min(framesLived_ / ringInterval_, static_cast<int>(farthestHops_));
+    return colorForAge(framesLived_ - youngestRing * ringInterval_).getBrightness();
+}
+
+bool SeekableRippleEffect::isFinished() const {
+    return framesLived_ >= maxLifetime_;
+}
+
+void SeekableRippleEffect::seek(int frame) {
+    framesLived_ = frame;
+}
+
+int SeekableRippleEffect::getFrame() const {
+    return framesLived_;
+}
+
+Color SeekableRippleEffect::colorForHops(uint8_t hops, int frame) const {
+    if (hops == Topology::UNREACHABLE_HOPS || (hops > 0 && !propagates_)) {
+        return Color(0, 0, 0);
+    }
+
+    // How long this key has been lit. Negative means the wave has not reached it yet.
+    return colorForAge(frame - hops * ringInterval_);
+}
+
+Color SeekableRippleEffect::colorForAge(int age) const {
+    if (age < 0 || age >= RippleEffect::FADE_STEPS * stepDuration_) {
+        return Color(0, 0, 0);
+    }
+
+    // The same phase RippleEffect reaches after `age` frames, without stepping through them.
+    return RippleEffect::fadeColor(color_, static_cast<uint16_t>(age * phaseStep_));
+}
@@ -0,0 +1,40 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Effects/SolidColorEffect.h"
+
+SolidColorEffect::SolidColorEffect(const Topology& /*topology*/, const Color& color, int maxLifetime)
+    : color_(color),
+    maxLifetime_(maxLifetime)
+{
+}
+
+void SolidColorEffect::update() {
+    // Only counted when there is a limit, so an endless effect never overflows.
+    if (maxLifetime_ > 0) {
+        framesLived_++;
+    }
+}
+
+Color SolidColorEffect::getColorForKey(const Key& /*key*/) const {
+    return isFinished() ? Color(0, 0, 0) : color_;
+}
+
+void SolidColorEffect::composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const {
+    if (isFinished() || color_ == Color(0, 0, 0, 0)) {
+        return;
+    }
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        frame[i] = frame[i].add(color_);
+        touched.insert(i);
+    }
+}
+
+bool SolidColorEffect::isFinished() const {
+    return maxLifetime_ > 0 && framesLived_ >= maxLifetime_;
+}
+
+uint8_t SolidColorEffect::getIntensity() const {
+    return isFinished() ? 0 : color_.getBrightness();
+}
@@ -0,0 +1,216 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Effects/SparksEffect.h"
+#include "Core/Effects/RippleEffect.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Emission speeds, in key units per frame. With DRAG the fastest sparks
+// travel about four keys before they stop.
+constexpr float MIN_SPEED = 0.05f;
+constexpr float MAX_SPEED = 0.25f;
+
+// The grid starts at a quarter of a key per cell and grows until it fits the budget.
+constexpr float MIN_CELL_SIZE = 0.25f;
+constexpr float CELL_GROWTH = 1.25f;
+
+} // namespace
+
+size_t SparksEffect::stateSize(const Topology& topology) {
+    return StateBuffer::sizeFor<uint16_t>(GRID_CELLS_PER_KEY * topology.getKeys().size());
+}
+
+SparksEffect::SparksEffect(const Topology& topology, StateBuffer state, uint32_t seed)
+    : topology_(&topology),
+    rng_(seed),
+    keyForCell_(state.take<uint16_t>(GRID_CELLS_PER_KEY * topology.getKeys().size()))
+{
+    constexpr float TWO_PI = 6.28318530718f;
+    for (size_t d = 0; d < DIRECTION_COUNT; ++d) {
+        const float angle = TWO_PI * static_cast<float>(d) / static_cast<float>(DIRECTION_COUNT);
+        directionX_[d] = std::cos(angle);
+        directionY_[d] = std::sin(angle);
+    }
+    buildGrid();
+}
+
+void SparksEffect::buildGrid() {
+    const Span<const Key> keys = topology_->getKeys();
+    for (uint16_t& cell : keyForCell_) {
+        cell = NO_KEY;
+    }
+    if (keys.empty()) {
+        return;
+    }
+
+    // The bounding box of the keys, with room for SPLAT_RADIUS on every side.
+    float minX = keys[0].getPosition().getX();
+    float minY = keys[0].getPosition().getY();
+    float maxX = minX;
+    float maxY = minY;
+    for (const Key& key : keys) {
+        minX = std::min(minX, key.getPosition().getX());
+        minY = std::min(minY, key.getPosition().getY());
+        maxX = std::max(maxX, key.getPosition().getX());
+        maxY = std::max(maxY, key.getPosition().getY());
+    }
+    originX_ = minX - SPLAT_RADIUS;
+    originY_ = minY - SPLAT_RADIUS;
+    const float spanX = maxX - minX + 2.0f * SPLAT_RADIUS;
+    const float spanY = maxY - minY + 2.0f * SPLAT_RADIUS;
+
+    cellSize_ = MIN_CELL_SIZE;
+    auto cellsFor = [&](float cellSize) {
+        return static_cast<size_t>(std::ceil(spanX / cellSize)) * static_cast<size_t>(std::ceil(spanY / cellSize));
+    };
+    while (cellsFor(cellSize_) > keyForCell_.size()) {
+        cellSize_ *= CELL_GROWTH;
+    }
+    inverseCellSize_ = 1.0f / cellSize_;
+    columns_ = static_cast<size_t>(std::ceil(spanX / cellSize_));
+    rows_ = static_cast<size_t>(std::ceil(spanY / cellSize_));
+    width_ = static_cast<float>(columns_) * cellSize_;
+    height_ = static_cast<float>(rows_) * cellSize_;
+
+    // Stamp each key onto the cells whose centers lie within SPLAT_RADIUS,
+    // keeping the nearest key where two overlap. The current owner's distance
+    // is recomputed rather than stored, so no scratch buffer is needed.
+    auto distanceSquared = [&](size_t keyIndex, size_t column, size_t row) {
+        const float dx = (static_cast<float>(column) + 0.5f) * cellSize_ - (keys[keyIndex].getPosition().getX() - originX_);
+        const float dy = (static_cast<float>(row) + 0.5f) * cellSize_ - (keys[keyIndex].getPosition().getY() - originY_);
+        return dx * dx + dy * dy;
+    };
+    constexpr float RADIUS_SQUARED = SPLAT_RADIUS * SPLAT_RADIUS;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        const float x = keys[k].getPosition().getX() - originX_;
+        const float y = keys[k].getPosition().getY() - originY_;
+        const size_t firstColumn = static_cast<size_t>(std::max(0.0f, (x - SPLAT_RADIUS) * inverseCellSize_));
+        const size_t lastColumn = std::min(columns_ - 1, static_cast<size_t>((x + SPLAT_RADIUS) * inverseCellSize_));
+        const size_t firstRow = static_cast<size_t>(std::max(0.0f, (y - SPLAT_RADIUS) * inverseCellSize_));
+        const size_t lastRow = std::min(rows_ - 1, static_cast<size_t>((y + SPLAT_RADIUS) * inverseCellSize_));
+        for (size_t row = firstRow; row <= lastRow; ++row) {
+            for (size_t column = firstColumn; column <= lastColumn; ++column) {
+                const float d2 = distanceSquared(k, column, row);
+                if (d2 > RADIUS_SQUARED) {
+                    continue;
+                }
+                uint16_t& owner = keyForCell_[row * columns_ + column];
+                if (owner == NO_KEY || d2 < distanceSquared(owner, column, row)) {
+                    owner = static_cast<uint16_t>(k);
+                }
+            }
+        }
+    }
+}
+
+size_t SparksEffect::emit(const Key& origin, const Color& color, size_t count, int lifetime) {
+    const size_t emitted = std::min(count, MAX_PARTICLES - count_);
+    const float x = origin.getPosition().getX() - originX_;
+    const float y = origin.getPosition().getY() - originY_;
+
+    // The same Q8.8 fade as the ripples, over `lifetime` frames; each spark
+    // then gets up to half as long again, so a burst thins out gradually.
+    const int baseStep = 0x10000 / std::min(std::max(lifetime, 1), 0xFFFF);
+    constexpr float SPEED_SCALE = (MAX_SPEED - MIN_SPEED) / 255.0f;
+    for (size_t n = 0; n < emitted; ++n) {
+        const size_t i = count_++;
+        const uint32_t bits = rng_.next();
+        const size_t direction = bits % DIRECTION_COUNT;
+        const float speed = MIN_SPEED + static_cast<float>((bits >> 8) & 0xFF) * SPEED_SCALE;
+        x_[i] = x;
+        y_[i] = y;
+        vx_[i] = directionX_[direction] * speed;
+        vy_[i] = directionY_[direction] * speed;
+        color_[i] = color;
+        phase_[i] = 0;
+        // Between baseStep and two thirds of it, i.e. between 1x and 1.5x the lifetime.
+        const int jitter = (baseStep * static_cast<int>((bits >> 16) & 0xFF)) / 768;
+        phaseStep_[i] = static_cast<uint16_t>(std::min(0xFFFF, std::max(1, baseStep - jitter)));
+    }
+    return emitted;
+}
+
+void SparksEffect::update() {
+    const size_t count = count_;
+
+    // --- 1. MOVE ---
+    // Plain float arithmetic over contiguous arrays, with no branch: vectorized.
+    for (size_t i = 0; i < count; ++i) {
+        x_[i] += vx_[i];
+        y_[i] += vy_[i];
+        vx_[i] *= DRAG;
+        vy_[i] *= DRAG;
+    }
+
+    // --- 2. AGE AND COMPACT ---
+    // Survivors are moved down over the dead, keeping their order, so the
+    // live particles stay packed at the front of every array.
+    size_t alive = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t phase = static_cast<uint32_t>(phase_[i]) + phaseStep_[i];
+        const bool inside = x_[i] >= 0.0f && x_[i] < width_ && y_[i] >= 0.0f && y_[i] < height_;
+        if (phase > 0xFFFF || !inside) {
+            continue;
+        }
+        if (alive != i) {
+            x_[alive] = x_[i];
+            y_[alive] = y_[i];
+            vx_[alive] = vx_[i];
+            vy_[alive] = vy_[i];
+            color_[alive] = color_[i];
+            phaseStep_[alive] = phaseStep_[i];
+        }
+        phase_[alive] = static_cast<uint16_t>(phase);
+        ++alive;
+    }
+    count_ = alive;
+}
+
+Color SparksEffect::getColorForKey(const Key& key) const {
+    Color color(0, 0, 0);
+    for (size_t i = 0; i < count_; ++i) {
+        if (keyAt(x_[i], y_[i]) == key.getIndex()) {
+            color = color.add(colorOf(i));
+        }
+    }
+    return color;
+}
+
+void SparksEffect::composite(Span<const Key> /*keys*/, Span<Color> frame, KeySet& touched) const {
+    for (size_t i = 0; i < count_; ++i) {
+        const uint16_t key = keyAt(x_[i], y_[i]);
+        if (key != NO_KEY) {
+            frame[key] = frame[key].add(colorOf(i));
+            touched.insert(key);
+        }
+    }
+}
+
+bool SparksEffect::isFinished() const {
+    return count_ == 0;
+}
+
+uint8_t SparksEffect::getIntensity() const {
+    uint8_t brightest = 0;
+    for (size_t i = 0; i < count_; ++i) {
+        brightest = std::max(brightest, colorOf(i).getBrightness());
+    }
+    return brightest;
+}
+
+uint16_t SparksEffect::keyAt(float x, float y) const {
+    if (columns_ == 0) {
+        return NO_KEY;
+    }
+    // Live particles are inside the grid; the clamps only absorb rounding at the far edges.
+    const size_t column = std::min(columns_ - 1, static_cast<size_t>(x * inverseCellSize_));
+    const size_t row = std::min(rows_ - 1, static_cast<size_t>(y * inverseCellSize_));
+    return keyForCell_[row * columns_ + column];
+}
+
+Color SparksEffect::colorOf(size_t particle) const {
+    return RippleEffect::fadeColor(color_[particle], phase_[particle]);
+}
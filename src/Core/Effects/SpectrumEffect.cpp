@@ -0,0 +1,175 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Effects/SpectrumEffect.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// A full-scale sine through the Hann window peaks at N/4 in its bin; band
+// powers are divided by that peak squared, so 0 dB is a full-scale tone.
+constexpr float FULL_SCALE_POWER = static_cast<float>(SpectrumEffect::FFT_SIZE * SpectrumEffect::FFT_SIZE) / 16.0f;
+
+// Keeps log10() finite for a band of pure silence.
+constexpr float SILENCE = 1e-12f;
+
+constexpr float SAMPLE_SCALE = 1.0f / 32768.0f;
+
+} // namespace
+
+size_t SpectrumEffect::stateSize(const Topology& topology) {
+    const size_t keyCount = topology.getKeys().size();
+    return StateBuffer::sizeFor<uint8_t>(keyCount) + StateBuffer::sizeFor<float>(keyCount);
+}
+
+SpectrumEffect::SpectrumEffect(const Topology& topology, StateBuffer state)
+    : topology_(&topology),
+    columnOf_(state.take<uint8_t>(topology.getKeys().size())),
+    bottomOf_(state.take<float>(topology.getKeys().size()))
+{
+    const Span<const Key> keys = topology.getKeys();
+    if (keys.empty()) {
+        return;
+    }
+
+    float minX = keys[0].getPosition().getX();
+    float minY = keys[0].getPosition().getY();
+    float maxX = minX;
+    float maxY = minY;
+    for (const Key& key : keys) {
+        minX = std::min(minX, key.getPosition().getX());
+        minY = std::min(minY, key.getPosition().getY());
+        maxX = std::max(maxX, key.getPosition().getX());
+        maxY = std::max(maxY, key.getPosition().getY());
+    }
+
+    // One column per key unit across, wider if that would make too many. A
+    // key belongs to the column its position falls in, so staggered rows share
+    // columns the way they line up on the board.
+    const float columnWidth = std::max(1.0f, (maxX - minX + 1.0f) / static_cast<float>(MAX_COLUMNS));
+    columnCount_ = std::min(MAX_COLUMNS, static_cast<size_t>((maxX - minX) / columnWidth) + 1);
+
+    // The bottom row starts lighting as soon as a bar rises; the top row is
+    // full when the bar is.
+    rowHeight_ = 1.0f / (maxY - minY + 1.0f);
+    for (const Key& key : keys) {
+        const size_t index = key.getIndex();
+        const size_t column = static_cast<size_t>((key.getPosition().getX() - minX) / columnWidth);
+        columnOf_[index] = static_cast<uint8_t>(std::min(columnCount_ - 1, column));
+        bottomOf_[index] = (maxY - key.getPosition().getY()) * rowHeight_;
+    }
+}
+
+void SpectrumEffect::attach(PcmRing& source, const Color& color) {
+    source_ = &source;
+    color_ = color;
+
+    // Band c ends at MIN_FREQUENCY * ratio^((c + 1) / columns), so the bands
+    // are spaced evenly in pitch. Every band gets at least one bin, starting
+    // above DC; at low sample rates the highest bands may be left empty.
+    const float sampleRate = static_cast<float>(std::max<uint32_t>(source.getSampleRate(), 1));
+    const float binWidth = sampleRate / static_cast<float>(FFT_SIZE);
+    const float ratio = std::max(1.0f, std::min(MAX_FREQUENCY, 0.5f * sampleRate) / MIN_FREQUENCY);
+    size_t start = 1;
+    for (size_t c = 0; c < columnCount_; ++c) {
+        bandStart_[c] = static_cast<uint16_t>(start);
+        const float upper = MIN_FREQUENCY * std::pow(ratio, static_cast<float>(c + 1) / static_cast<float>(columnCount_));
+        const size_t end = std::max(start + 1, static_cast<size_t>(upper / binWidth + 0.5f));
+        start = std::min(end, Fft::BINS);
+    }
+    bandStart_[columnCount_] = static_cast<uint16_t>(start);
+}
+
+size_t SpectrumEffect::drain() {
+    // Read straight into the history ring, up to its end and then around
+    // again, until the stream is empty. Older samples are overwritten, so a
+    // backlog costs one copy and leaves only the newest FFT_SIZE behind.
+    size_t total = 0;
+    for (;;) {
+        const size_t room = FFT_SIZE - historyHead_;
+        const size_t read = source_->pop(&history_[historyHead_], room);
+        historyHead_ = (historyHead_ + read) & (FFT_SIZE - 1);
+        total += read;
+        if (read < room) {
+            return total;
+        }
+    }
+}
+
+void SpectrumEffect::update() {
+    // --- 1. ANALYZE ---
+    // Only when new audio arrived; a stalled or ended stream reads as silence.
+    const bool fresh = source_ && drain() > 0;
+    if (fresh) {
+        for (size_t i = 0; i < FFT_SIZE; ++i) {
+            samples_[i] = static_cast<float>(history_[(historyHead_ + i) & (FFT_SIZE - 1)]) * SAMPLE_SCALE;
+        }
+        fft_.powerSpectrum(samples_, power_);
+    }
+
+    // --- 2. SET THE BARS ---
+    // A bar jumps up to its band's level and falls back by FALL per frame.
+    // Below what the bottom row can show, it is dropped to zero.
+    const float visible = rowHeight_ / 255.0f;
+    dark_ = true;
+    for (size_t c = 0; c < columnCount_; ++c) {
+        float target = 0.0f;
+        if (fresh) {
+            float bandPower = 0.0f;
+            for (size_t b = bandStart_[c]; b < bandStart_[c + 1]; ++b) {
+                bandPower += power_[b];
+            }
+            const float decibels = 10.0f * std::log10(bandPower / FULL_SCALE_POWER + SILENCE);
+            target = std::min(1.0f, std::max(0.0f, 1.0f - decibels / FLOOR_DB));
+        }
+        float level = std::max(target, level_[c] * FALL);
+        if (level < visible) {
+            level = 0.0f;
+        }
+        level_[c] = level;
+        dark_ = dark_ && level == 0.0f;
+    }
+}
+
+Color SpectrumEffect::getColorForKey(const Key& key) const {
+    return colorOf(key.getIndex());
+}
+
+void SpectrumEffect::composite(Span<const Key> keys, Span<Color> frame, KeySet& touched) const {
+    if (dark_) {
+        return;
+    }
+    const Color black(0, 0, 0);
+    for (const Key& key : keys) {
+        const size_t i = key.getIndex();
+        const Color color = colorOf(i);
+        if (color != black) {
+            frame[i] = frame[i].add(color);
+            touched.insert(i);
+        }
+    }
+}
+
+bool SpectrumEffect::isFinished() const {
+    return dark_ && (!source_ || source_->isFinished());
+}
+
+uint8_t SpectrumEffect::getIntensity() const {
+    uint8_t brightest = 0;
+    if (!dark_) {
+        for (const Key& key : topology_->getKeys()) {
+            brightest = std::max(brightest, colorOf(key.getIndex()).getBrightness());
+        }
+    }
+    return brightest;
+}
+
+Color SpectrumEffect::colorOf(size_t index) const {
+    const float covered = (level_[columnOf_[index]] - bottomOf_[index]) / rowHeight_;
+    if (covered >= 1.0f) {
+        return color_;
+    }
+    const uint8_t intensity = covered > 0.0f ? static_cast<uint8_t>(covered * 255.0f) : 0;
+    return intensity > 0 ? color_.scale(intensity) : Color(0, 0, 0);
+}
@@ -0,0 +1,101 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Input/KeyTrace.h"
+
+namespace {
+
+constexpr uint8_t MAGIC[4] = { 'R', 'F', 'X', 'T' };
+
+} // namespace
+
+// --- KeyTraceWriter ---
+
+KeyTraceWriter::KeyTraceWriter(uint32_t seed) {
+    bytes_.reserve(256);
+    bytes_.insert(bytes_.end(), MAGIC, MAGIC + 4);
+    bytes_.push_back(static_cast<uint8_t>(VERSION & 0xFF));
+    bytes_.push_back(static_cast<uint8_t>(VERSION >> 8));
+    bytes_.push_back(0);
+    bytes_.push_back(0);
+    for (int shift = 0; shift < 32; shift += 8) {
+        bytes_.push_back(static_cast<uint8_t>(seed >> shift));
+    }
+}
+
+void KeyTraceWriter::append(uint32_t pollIndex, const KeyEvent& event) {
+    appendVarint(pollIndex - lastPollIndex_);
+    appendVarint(event.timestampMs - lastTimestampMs_);
+    appendVarint((static_cast<uint32_t>(event.keyIndex) << 1) | (event.action == KeyAction::Release ? 1u : 0u));
+    lastPollIndex_ = pollIndex;
+    lastTimestampMs_ = event.timestampMs;
+}
+
+void KeyTraceWriter::appendVarint(uint32_t value) {
+    // LEB128: seven bits per byte, lowest first; the high bit marks "more follows".
+    while (value >= 0x80) {
+        bytes_.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes_.push_back(static_cast<uint8_t>(value));
+}
+
+// --- KeyTraceReader ---
+
+KeyTraceReader::KeyTraceReader(Span<const uint8_t> bytes)
+    : bytes_(bytes)
+{
+    if (bytes_.size() < KeyTraceWriter::HEADER_SIZE) {
+        return;
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        if (bytes_[i] != MAGIC[i]) {
+            return;
+        }
+    }
+    const uint16_t version = static_cast<uint16_t>(bytes_[4] | (bytes_[5] << 8));
+    if (version != KeyTraceWriter::VERSION) {
+        return;
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        seed_ |= static_cast<uint32_t>(bytes_[8 + i]) << (8 * i);
+    }
+    offset_ = KeyTraceWriter::HEADER_SIZE;
+    valid_ = true;
+}
+
+bool KeyTraceReader::next(uint32_t& pollIndex, KeyEvent& event) {
+    if (!valid_ || offset_ >= bytes_.size()) {
+        return false;
+    }
+
+    uint32_t pollDelta, timeDelta, keyAndAction;
+    if (!readVarint(pollDelta) || !readVarint(timeDelta) || !readVarint(keyAndAction) || (keyAndAction >> 1) > 0xFFFF) {
+        // A truncated or corrupt record ends the trace.
+        valid_ = false;
+        return false;
+    }
+
+    pollIndex_ += pollDelta;
+    timestampMs_ += timeDelta;
+    pollIndex = pollIndex_;
+    event.timestampMs = timestampMs_;
+    event.keyIndex = static_cast<uint16_t>(keyAndAction >> 1);
+    event.action = (keyAndAction & 1) ? KeyAction::Release : KeyAction::Press;
+    return true;
+}
+
+bool KeyTraceReader::readVarint(uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset_ >= bytes_.size()) {
+            return false;
+        }
+        const uint8_t byte = bytes_[offset_++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -2,198 +2,290 @@
 
 #include "Core/Keyboard/Keyboard.h"
 #include "Core/Keyboard/KeyCodes.h"
-#include <algorithm>
-
-Keyboard::Keyboard() {
-	keys_.reserve(static_cast<size_t>(KeyCode::KEY_COUNT));
-	initializeLayout();
-	// Assign indices to all keys
-	for (size_t i = 0; i < keys_.size(); ++i) {
-		keys_[i].index_ = i;
+#include <array>
+#include <utility>
+
+// All the keyboard data is computed by the compiler from the LAYOUT table below
+// and stored as constants, so nothing here runs at startup.
+namespace {
+
+/**
+ * @brief One key of the layout table: its code and the position of its center, in key units.
+ */
+struct LayoutEntry {
+	KeyCode code;
+	float x;
+	float y;
+};
+
+constexpr LayoutEntry LAYOUT[] = {
+	// --- Row 0: Function Row (Y = 0.0) ---
+	{ KeyCode::ESCAPE, 0.0f, 0.0f },
+	{ KeyCode::F1, 2.0f, 0.0f },
+	{ KeyCode::F2, 3.0f, 0.0f },
+	{ KeyCode::F3, 4.0f, 0.0f },
+	{ KeyCode::F4, 5.0f, 0.0f },
+	{ KeyCode::F5, 6.25f, 0.0f },
+	{ KeyCode::F6, 7.25f, 0.0f },
+	{ KeyCode::F7, 8.25f, 0.0f },
+	{ KeyCode::F8, 9.25f, 0.0f },
+	{ KeyCode::F9, 10.5f, 0.0f },
+	{ KeyCode::F10, 11.5f, 0.0f },
+	{ KeyCode::F11, 12.5f, 0.0f },
+	{ KeyCode::F12, 13.5f, 0.0f },
+
+	// --- Row 1: Number Row (Y = 1.25) ---
+	{ KeyCode::OEM_TILDE, 0.0f, 1.25f },
+	{ KeyCode::NUM_1, 1.0f, 1.25f },
+	{ KeyCode::NUM_2, 2.0f, 1.25f },
+	{ KeyCode::NUM_3, 3.0f, 1.25f },
+	{ KeyCode::NUM_4, 4.0f, 1.25f },
+	{ KeyCode::NUM_5, 5.0f, 1.25f },
+	{ KeyCode::NUM_6, 6.0f, 1.25f },
+	{ KeyCode::NUM_7, 7.0f, 1.25f },
+	{ KeyCode::NUM_8, 8.0f, 1.25f },
+	{ KeyCode::NUM_9, 9.0f, 1.25f },
+	{ KeyCode::NUM_0, 10.0f, 1.25f },
+	{ KeyCode::OEM_MINUS, 11.0f, 1.25f },
+	{ KeyCode::OEM_PLUS, 12.0f, 1.25f },
+	{ KeyCode::BACKSPACE, 13.5f, 1.25f }, // 2.0 units wide
+
+	// --- Row 2: QWERTY Row (Y = 2.25) ---
+	{ KeyCode::TAB, 0.25f, 2.25f }, // 1.5 units wide
+	{ KeyCode::Q, 1.5f, 2.25f },
+	{ KeyCode::W, 2.5f, 2.25f },
+	{ KeyCode::E, 3.5f, 2.25f },
+	{ KeyCode::R, 4.5f, 2.25f },
+	{ KeyCode::T, 5.5f, 2.25f },
+	{ KeyCode::Y, 6.5f, 2.25f },
+	{ KeyCode::U, 7.5f, 2.25f },
+	{ KeyCode::I, 8.5f, 2.25f },
+	{ KeyCode::O, 9.5f, 2.25f },
+	{ KeyCode::P, 10.5f, 2.25f },
+	{ KeyCode::OEM_LBRACKET, 11.5f, 2.25f },
+	{ KeyCode::OEM_RBRACKET, 12.5f, 2.25f },
+	{ KeyCode::OEM_BACKSLASH, 13.75f, 2.25f }, // 1.5 units wide
+
+	// --- Row 3: Home Row (Y = 3.25) ---
+	{ KeyCode::CAPS_LOCK, 0.375f, 3.25f }, // 1.75 units wide
+	{ KeyCode::A, 1.75f, 3.25f },
+	{ KeyCode::S, 2.75f, 3.25f },
+	{ KeyCode::D, 3.75f, 3.25f },
+	{ KeyCode::F, 4.75f, 3.25f },
+	{ KeyCode::G, 5.75f, 3.25f },
+	{ KeyCode::H, 6.75f, 3.25f },
+	{ KeyCode::J, 7.75f, 3.25f },
+	{ KeyCode::K, 8.75f, 3.25f },
+	{ KeyCode::L, 9.75f, 3.25f },
+	{ KeyCode::OEM_SEMICOLON, 10.75f, 3.25f },
+	{ KeyCode::OEM_QUOTE, 11.75f, 3.25f },
+	{ KeyCode::ENTER, 13.375f, 3.25f }, // 2.25 units wide
+
+	// --- Row 4: Bottom Row (Y = 4.25) ---
+	{ KeyCode::LEFT_SHIFT, 0.625f, 4.25f }, // 2.25 units wide
+	{ KeyCode::Z, 2.25f, 4.25f },
+	{ KeyCode::X, 3.25f, 4.25f },
+	{ KeyCode::C, 4.25f, 4.25f },
+	{ KeyCode::V, 5.25f, 4.25f },
+	{ KeyCode::B, 6.25f, 4.25f },
+	{ KeyCode::N, 7.25f, 4.25f },
+	{ KeyCode::M, 8.25f, 4.25f },
+	{ KeyCode::OEM_COMMA, 9.25f, 4.25f },
+	{ KeyCode::OEM_PERIOD, 10.25f, 4.25f },
+	{ KeyCode::OEM_SLASH, 11.25f, 4.25f },
+	{ KeyCode::RIGHT_SHIFT, 13.125f, 4.25f }, // 2.75 units wide
+
+	// --- Row 5: Modifier Row (Y = 5.25) ---
+	{ KeyCode::LEFT_CONTROL, 0.25f, 5.25f },
+	{ KeyCode::LEFT_WINDOWS, 1.5f, 5.25f },
+	{ KeyCode::LEFT_ALT, 2.75f, 5.25f },
+	{ KeyCode::SPACE, 6.375f, 5.25f }, // 5.75 units wide
+	{ KeyCode::RIGHT_ALT, 9.75f, 5.25f },
+	{ KeyCode::RIGHT_WINDOWS, 11.0f, 5.25f },
+	{ KeyCode::CONTEXT_MENU, 12.25f, 5.25f },
+	{ KeyCode::RIGHT_CONTROL, 13.75f, 5.25f },
+
+	// --- System keys (above nav cluster) ---
+	{ KeyCode::PRINT_SCREEN, 15.0f, 0.0f },
+	{ KeyCode::SCROLL_LOCK, 16.0f, 0.0f },
+	{ KeyCode::PAUSE_BREAK, 17.0f, 0.0f },
+
+	// --- Nav cluster ---
+	{ KeyCode::INSERT, 15.0f, 1.25f },
+	{ KeyCode::HOME, 16.0f, 1.25f },
+	{ KeyCode::PAGE_UP, 17.0f, 1.25f },
+	{ KeyCode::DELETE_KEY, 15.0f, 2.25f },
+	{ KeyCode::END, 16.0f, 2.25f },
+	{ KeyCode::PAGE_DOWN, 17.0f, 2.25f },
+
+	// --- Arrow keys ---
+	{ KeyCode::ARROW_UP, 16.0f, 4.25f },
+	{ KeyCode::ARROW_LEFT, 15.0f, 5.25f },
+	{ KeyCode::ARROW_DOWN, 16.0f, 5.25f },
+	{ KeyCode::ARROW_RIGHT, 17.0f, 5.25f },
+
+	// --- Numpad ---
+	{ KeyCode::NUM_LOCK, 18.5f, 1.25f },
+	{ KeyCode::NUMPAD_DIVIDE, 19.5f, 1.25f },
+	{ KeyCode::NUMPAD_MULTIPLY, 20.5f, 1.25f },
+	{ KeyCode::NUMPAD_SUBTRACT, 21.5f, 1.25f },
+	{ KeyCode::NUMPAD_7, 18.5f, 2.25f },
+	{ KeyCode::NUMPAD_8, 19.5f, 2.25f },
+	{ KeyCode::NUMPAD_9, 20.5f, 2.25f },
+	{ KeyCode::NUMPAD_ADD, 21.5f, 2.75f }, // Spans two rows
+	{ KeyCode::NUMPAD_4, 18.5f, 3.25f },
+	{ KeyCode::NUMPAD_5, 19.5f, 3.25f },
+	{ KeyCode::NUMPAD_6, 20.5f, 3.25f },
+	{ KeyCode::NUMPAD_1, 18.5f, 4.25f },
+	{ KeyCode::NUMPAD_2, 19.5f, 4.25f },
+	{ KeyCode::NUMPAD_3, 20.5f, 4.25f },
+	{ KeyCode::NUMPAD_ENTER, 21.5f, 4.75f }, // Spans two rows
+	{ KeyCode::NUMPAD_0, 19.0f, 5.25f }, // 2.0 units wide
+	{ KeyCode::NUMPAD_DECIMAL, 20.5f, 5.25f },
+};
+
+constexpr size_t LAYOUT_SIZE = sizeof(LAYOUT) / sizeof(LAYOUT[0]);
+static_assert(LAYOUT_SIZE <= MAX_KEYS, "The layout has more keys than MAX_KEYS.");
+// Neighbor indices and the KeyCode-to-index table store single bytes, and 0xFF marks a missing key.
+static_assert(LAYOUT_SIZE < NeighborIndexTraits<uint8_t>::MAX_POINTS, "The layout has too many keys for 8-bit key indices.");
+
+constexpr size_t KEY_CODE_COUNT = static_cast<size_t>(KeyCode::KEY_COUNT);
+constexpr uint8_t NO_KEY = 0xFF;
+
+// --- TUNING CONSTANT ---
+// Using Manhattan distance is a fast and effective heuristic for grid-like layouts.
+// Keys closer than this are immediate neighbors; the tolerance accounts for
+// slight layout imperfections.
+constexpr float NEIGHBOR_DISTANCE_THRESHOLD = 1.6f;
+
+constexpr Position positionOf(size_t index) {
+	return Position(LAYOUT[index].x, LAYOUT[index].y);
+}
+
+constexpr bool areNeighbors(size_t a, size_t b) {
+	// A key is not a neighbor of itself.
+	return a != b && positionOf(a).distanceManhattan(positionOf(b)) < NEIGHBOR_DISTANCE_THRESHOLD;
+}
+
+template<size_t... Indices>
+constexpr std::array<Key, LAYOUT_SIZE> makeKeys(std::index_sequence<Indices...>) {
+	return { { Key(static_cast<uint16_t>(LAYOUT[Indices].code), positionOf(Indices), static_cast<uint16_t>(Indices))... } };
+}
+
+constexpr size_t countNeighbors() {
+	size_t count = 0;
+	for (size_t i = 0; i < LAYOUT_SIZE; ++i) {
+		for (size_t j = 0; j < LAYOUT_SIZE; ++j) {
+			if (areNeighbors(i, j)) ++count;
+		}
 	}
+	return count;
+}
+
+constexpr size_t NEIGHBOR_COUNT = countNeighbors();
+static_assert(NEIGHBOR_COUNT <= 0xFFFF, "The layout has too many neighbor pairs for 16-bit offsets.");
 
-	buildNeighborMaps(); // Pre-calculate neighbors after creating keys
+/**
+ * @brief The adjacency in compressed-sparse-row form: the neighbors of key i are
+ *        indices[offsets[i]] up to indices[offsets[i + 1]].
+ */
+struct NeighborTable {
+	std::array<uint16_t, LAYOUT_SIZE + 1> offsets{};
+	std::array<uint8_t, NEIGHBOR_COUNT> indices{};
+};
+
+constexpr NeighborTable makeNeighborTable() {
+	NeighborTable table{};
+	size_t count = 0;
+	for (size_t i = 0; i < LAYOUT_SIZE; ++i) {
+		table.offsets[i] = static_cast<uint16_t>(count);
+		for (size_t j = 0; j < LAYOUT_SIZE; ++j) {
+			if (areNeighbors(i, j)) table.indices[count++] = static_cast<uint8_t>(j);
+		}
+	}
+	table.offsets[LAYOUT_SIZE] = static_cast<uint16_t>(count);
+	return table;
 }
 
-const std::vector<Key>& Keyboard::getKeys() const {
-	return keys_;
+constexpr NeighborTable NEIGHBORS = makeNeighborTable();
+
+constexpr size_t MASK_WORDS = (LAYOUT_SIZE + 63) / 64;
+
+// The same adjacency as bitmasks: the neighbors of key i are words [i * MASK_WORDS, (i + 1) * MASK_WORDS).
+constexpr std::array<uint64_t, LAYOUT_SIZE * MASK_WORDS> makeNeighborMasks() {
+	std::array<uint64_t, LAYOUT_SIZE * MASK_WORDS> masks{};
+	for (size_t i = 0; i < LAYOUT_SIZE; ++i) {
+		for (size_t n = NEIGHBORS.offsets[i]; n < NEIGHBORS.offsets[i + 1]; ++n) {
+			const size_t neighbor = NEIGHBORS.indices[n];
+			masks[i * MASK_WORDS + neighbor / 64] |= uint64_t{ 1 } << (neighbor % 64);
+		}
+	}
+	return masks;
 }
 
-Key* Keyboard::findKeyById(KeyCode id) {
-	auto it = std::find_if(keys_.begin(), keys_.end(), [id](const Key& key) {
-		// Apply the same fix here for consistency.
-		return key.getId() == static_cast<uint16_t>(id);
-		});
-	// The const_cast is still needed here to return a non-const pointer.
-	return (it != keys_.end()) ? const_cast<Key*>(&(*it)) : nullptr;
+constexpr std::array<uint8_t, KEY_CODE_COUNT> makeIndexTable() {
+	std::array<uint8_t, KEY_CODE_COUNT> table{};
+	for (size_t code = 0; code < KEY_CODE_COUNT; ++code) {
+		table[code] = NO_KEY;
+	}
+	for (size_t i = 0; i < LAYOUT_SIZE; ++i) {
+		table[static_cast<size_t>(LAYOUT[i].code)] = static_cast<uint8_t>(i);
+	}
+	return table;
 }
 
-void Keyboard::buildNeighborMaps() {
-	// --- TUNING CONSTANT ---
-	// This constant is local to this function because it's an implementation detail
-	// of how we build the neighbor map. It does not need to be in the header file.
-	constexpr float NEIGHBOR_DISTANCE_THRESHOLD = 1.6f;
-
-	// Iterate using indices to get non-const access to both keys,
-	// which is safer and avoids complex casting.
-	for (size_t i = 0; i < keys_.size(); ++i) {
-		for (size_t j = 0; j < keys_.size(); ++j) {
-			if (i == j) continue; // A key is not a neighbor of itself
-
-			Key& key_a = keys_[i];
-			Key& key_b = keys_[j];
-
-			// Using Manhattan distance is a fast and effective heuristic for grid-like layouts.
-			// A distance of ~2 means they are immediate neighbors.
-			// We use a small tolerance (e.g., 2f) to account for slight layout imperfections.
-			if (key_a.getPosition().distanceManhattan(key_b.getPosition()) < NEIGHBOR_DISTANCE_THRESHOLD) {
-				// Both key_a and key_b are non-const, so we can safely take the address
-				// of key_b to get a Key*, which can then be implicitly and safely
-				// converted to the const Key* that the vector expects.
-				key_a.neighbors.push_back(&key_b);
+constexpr std::array<uint8_t, LAYOUT_SIZE * LAYOUT_SIZE> makeHopDistanceTable() {
+	std::array<uint8_t, LAYOUT_SIZE * LAYOUT_SIZE> table{};
+	for (size_t i = 0; i < table.size(); ++i) {
+		table[i] = Keyboard::UNREACHABLE_HOPS;
+	}
+
+	// One breadth-first search per source key, walking the CSR neighbor lists.
+	for (size_t source = 0; source < LAYOUT_SIZE; ++source) {
+		const size_t row = source * LAYOUT_SIZE;
+		std::array<uint8_t, LAYOUT_SIZE> queue{};
+		size_t head = 0;
+		size_t tail = 0;
+
+		table[row + source] = 0;
+		queue[tail++] = static_cast<uint8_t>(source);
+		while (head < tail) {
+			const size_t current = queue[head++];
+			const uint8_t hops = table[row + current];
+			if (hops + 1 >= Keyboard::UNREACHABLE_HOPS) continue;
+
+			for (size_t n = NEIGHBORS.offsets[current]; n < NEIGHBORS.offsets[current + 1]; ++n) {
+				const uint8_t next = NEIGHBORS.indices[n];
+				if (table[row + next] == Keyboard::UNREACHABLE_HOPS) {
+					table[row + next] = static_cast<uint8_t>(hops + 1);
+					queue[tail++] = next;
+				}
 			}
 		}
 	}
+	return table;
 }
 
-void Keyboard::initializeLayout() {
-    keys_.reserve(static_cast<uint16_t>(KeyCode::KEY_COUNT)); // Pre-allocate memory for performance
-
-    // --- Row 0: Function Row (Y = 0.0) ---
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::ESCAPE), Position(0.0f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F1), Position(2.0f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F2), Position(3.0f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F3), Position(4.0f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F4), Position(5.0f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F5), Position(6.25f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F6), Position(7.25f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F7), Position(8.25f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F8), Position(9.25f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F9), Position(10.5f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F10), Position(11.5f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F11), Position(12.5f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F12), Position(13.5f, 0.0f));
-
-    // --- Row 1: Number Row (Y = 1.25) ---
-    float x = 0.0f;
-    float y = 1.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_TILDE), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_1), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_2), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_3), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_4), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_5), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_6), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_7), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_8), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_9), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_0), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_MINUS), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_PLUS), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::BACKSPACE), Position(x + 0.5f, y)); // 2.0 units wide
-
-    // --- Row 2: QWERTY Row (Y = 2.25) ---
-    x = 0.0f;
-    y = 2.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::TAB), Position(x + 0.25f, y)); x += 1.5f; // 1.5 units wide
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::Q), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::W), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::E), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::R), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::T), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::Y), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::U), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::I), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::O), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::P), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_LBRACKET), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_RBRACKET), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_BACKSLASH), Position(x + 0.25f, y)); // 1.5 units wide
-
-    // --- Row 3: Home Row (Y = 3.25) ---
-    x = 0.0f;
-    y = 3.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::CAPS_LOCK), Position(x + 0.375f, y)); x += 1.75f; // 1.75 units wide
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::A), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::S), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::D), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::F), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::G), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::H), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::J), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::K), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::L), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_SEMICOLON), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_QUOTE), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::ENTER), Position(x + 0.625f, y)); // 2.25 units wide
-
-    // --- Row 4: Bottom Row (Y = 4.25) ---
-    x = 0.0f;
-    y = 4.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::LEFT_SHIFT), Position(x + 0.625f, y)); x += 2.25f; // 2.25 units wide
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::Z), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::X), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::C), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::V), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::B), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::N), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::M), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_COMMA), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_PERIOD), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::OEM_SLASH), Position(x, y)); x += 1.0f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::RIGHT_SHIFT), Position(x + 0.875f, y)); // 2.75 units wide
-
-    // --- Row 5: Modifier Row (Y = 5.25) ---
-    x = 0.0f;
-    y = 5.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::LEFT_CONTROL), Position(x + 0.25f, y)); x += 1.5f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::LEFT_WINDOWS), Position(x, y)); x += 1.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::LEFT_ALT), Position(x, y)); x += 1.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::SPACE), Position(x + 2.375f, y)); x += 5.75f; // 5.75 units wide
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::RIGHT_ALT), Position(x, y)); x += 1.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::RIGHT_WINDOWS), Position(x, y)); x += 1.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::CONTEXT_MENU), Position(x, y)); x += 1.25f;
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::RIGHT_CONTROL), Position(x + 0.25f, y));
-
-    // --- Right-hand Clusters (Navigation and Numpad) ---
-    const float nav_cluster_x = 15.0f;
-    const float numpad_x = 18.5f;
-
-    // System keys (above nav cluster)
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::PRINT_SCREEN), Position(nav_cluster_x, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::SCROLL_LOCK), Position(nav_cluster_x + 1.0f, 0.0f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::PAUSE_BREAK), Position(nav_cluster_x + 2.0f, 0.0f));
-
-    // Nav cluster
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::INSERT), Position(nav_cluster_x, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::HOME), Position(nav_cluster_x + 1.0f, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::PAGE_UP), Position(nav_cluster_x + 2.0f, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::DELETE_KEY), Position(nav_cluster_x, 2.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::END), Position(nav_cluster_x + 1.0f, 2.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::PAGE_DOWN), Position(nav_cluster_x + 2.0f, 2.25f));
-
-    // Arrow keys
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::ARROW_UP), Position(nav_cluster_x + 1.0f, 4.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::ARROW_LEFT), Position(nav_cluster_x, 5.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::ARROW_DOWN), Position(nav_cluster_x + 1.0f, 5.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::ARROW_RIGHT), Position(nav_cluster_x + 2.0f, 5.25f));
-
-    // Numpad
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUM_LOCK), Position(numpad_x, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_DIVIDE), Position(numpad_x + 1.0f, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_MULTIPLY), Position(numpad_x + 2.0f, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_SUBTRACT), Position(numpad_x + 3.0f, 1.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_7), Position(numpad_x, 2.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_8), Position(numpad_x + 1.0f, 2.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_9), Position(numpad_x + 2.0f, 2.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_ADD), Position(numpad_x + 3.0f, 2.75f)); // Spans two rows
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_4), Position(numpad_x, 3.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_5), Position(numpad_x + 1.0f, 3.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_6), Position(numpad_x + 2.0f, 3.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_1), Position(numpad_x, 4.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_2), Position(numpad_x + 1.0f, 4.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_3), Position(numpad_x + 2.0f, 4.25f));
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_ENTER), Position(numpad_x + 3.0f, 4.75f)); // Spans two rows
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_0), Position(numpad_x + 0.5f, 5.25f)); // 2.0 units wide
-    keys_.emplace_back(static_cast<uint16_t>(KeyCode::NUMPAD_DECIMAL), Position(numpad_x + 2.0f, 5.25f));
-}
\ No newline at end of file
+constexpr std::array<Key, LAYOUT_SIZE> KEYS = makeKeys(std::make_index_sequence<LAYOUT_SIZE>{});
+constexpr std::array<uint8_t, KEY_CODE_COUNT> INDEX_BY_CODE = makeIndexTable();
+constexpr std::array<uint64_t, LAYOUT_SIZE * MASK_WORDS> NEIGHBOR_MASKS = makeNeighborMasks();
+constexpr std::array<uint8_t, LAYOUT_SIZE * LAYOUT_SIZE> HOP_DISTANCES = makeHopDistanceTable();
+
+} // namespace
+
+Keyboard::Keyboard()
+	: Topology(Span<const Key>(KEYS.data(), KEYS.size()),
+		Span<const uint16_t>(NEIGHBORS.offsets.data(), NEIGHBORS.offsets.size()),
+		Span<const uint8_t>(NEIGHBORS.indices.data(), NEIGHBORS.indices.size()),
+		Span<const uint64_t>(NEIGHBOR_MASKS.data(), NEIGHBOR_MASKS.size()),
+		Span<const uint8_t>(HOP_DISTANCES.data(), HOP_DISTANCES.size()))
+{
+}
+
+const Key* Keyboard::findKeyById(KeyCode id) const {
+	const size_t code = static_cast<size_t>(id);
+	if (code >= KEY_CODE_COUNT || INDEX_BY_CODE[code] == NO_KEY) {
+		return nullptr;
+	}
+	return &KEYS[INDEX_BY_CODE[code]];
+}
@@ -0,0 +1,179 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Keyboard/Topology.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+Topology Topology::fromPoints(Span<const Position> points, float neighborDistance) {
+    if (points.size() > MAX_POINTS) {
+        throw std::length_error("Topology::fromPoints(): more than MAX_POINTS points.");
+    }
+
+    Topology topology;
+    const size_t count = points.size();
+
+    topology.ownedKeys_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        topology.ownedKeys_.emplace_back(static_cast<uint16_t>(i), points[i], static_cast<uint16_t>(i));
+    }
+
+    // --- 1. Bucket the points into a sparse grid ---
+    // Cells are exactly neighborDistance wide, which keeps the 3x3 search exact
+    // and bounds the points a search visits by the neighbors it finds, however
+    // clustered they are. Only occupied cells are stored, in a hash table, so a
+    // very spread out layout never allocates a huge grid either.
+    float minX = 0.0f, minY = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        minX = (i == 0 || points[i].getX() < minX) ? points[i].getX() : minX;
+        minY = (i == 0 || points[i].getY() < minY) ? points[i].getY() : minY;
+    }
+    const float cellSize = neighborDistance > 0.0f ? neighborDistance : 1.0f;
+
+    // Cell coordinates are clamped far beyond any real layout. Clamping never
+    // moves two points further apart, so the search stays exact.
+    constexpr float MAX_CELL_COORDINATE = static_cast<float>(1u << 30);
+    auto cellKey = [&](size_t i) {
+        const uint64_t column = static_cast<uint32_t>(std::min((points[i].getX() - minX) / cellSize, MAX_CELL_COORDINATE));
+        const uint64_t row = static_cast<uint32_t>(std::min((points[i].getY() - minY) / cellSize, MAX_CELL_COORDINATE));
+        return (row << 32) | column;
+    };
+
+    // Open addressing with linear probing, at most half full.
+    constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFF;
+    size_t tableBits = 1;
+    while ((size_t{ 1 } << tableBits) < 2 * count) {
+        ++tableBits;
+    }
+    const size_t tableMask = (size_t{ 1 } << tableBits) - 1;
+    std::vector<uint32_t> slots(tableMask + 1, EMPTY_SLOT);
+    std::vector<uint64_t> cellKeys;
+    auto slotOf = [&](uint64_t key) {
+        size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - tableBits));
+        while (slots[slot] != EMPTY_SLOT && cellKeys[slots[slot]] != key) {
+            slot = (slot + 1) & tableMask;
+        }
+        return slot;
+    };
+
+    std::vector<uint32_t> pointCells(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t key = cellKey(i);
+        const size_t slot = slotOf(key);
+        if (slots[slot] == EMPTY_SLOT) {
+            slots[slot] = static_cast<uint32_t>(cellKeys.size());
+            cellKeys.push_back(key);
+        }
+        pointCells[i] = slots[slot];
+    }
+    const size_t cellCount = cellKeys.size();
+
+    // Counting sort: the points of cell c are cellPoints[cellStarts[c]] up to cellPoints[cellStarts[c + 1]].
+    std::vector<uint32_t> cellStarts(cellCount + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        ++cellStarts[pointCells[i] + 1];
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        cellStarts[c + 1] += cellStarts[c];
+    }
+    std::vector<uint16_t> cellPoints(count);
+    {
+        std::vector<uint32_t> cursor(cellStarts.begin(), cellStarts.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            cellPoints[cursor[pointCells[i]]++] = static_cast<uint16_t>(i);
+        }
+    }
+
+    // --- 2. Search the 3x3 block of cells around every point ---
+    std::vector<uint32_t> offsets;
+    std::vector<uint16_t> indices;
+    offsets.reserve(count + 1);
+    std::vector<uint16_t> candidates;
+    for (size_t i = 0; i < count; ++i) {
+        offsets.push_back(static_cast<uint32_t>(indices.size()));
+
+        const uint64_t key = cellKeys[pointCells[i]];
+        const uint64_t column = key & 0xFFFFFFFF;
+        const uint64_t row = key >> 32;
+
+        candidates.clear();
+        for (uint64_t r = (row > 0 ? row - 1 : 0); r <= row + 1; ++r) {
+            for (uint64_t c = (column > 0 ? column - 1 : 0); c <= column + 1; ++c) {
+                const uint32_t other = slots[slotOf((r << 32) | c)];
+                if (other == EMPTY_SLOT) continue;
+                for (uint32_t p = cellStarts[other]; p < cellStarts[other + 1]; ++p) {
+                    const uint16_t j = cellPoints[p];
+                    // A point is not a neighbor of itself.
+                    if (j != i && points[i].distanceManhattan(points[j]) < neighborDistance) {
+                        candidates.push_back(j);
+                    }
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        indices.insert(indices.end(), candidates.begin(), candidates.end());
+    }
+    offsets.push_back(static_cast<uint32_t>(indices.size()));
+
+    // Small topologies take the 1-byte layout and the neighbor masks, like the Keyboard.
+    topology.keys_ = Span<const Key>(topology.ownedKeys_.data(), topology.ownedKeys_.size());
+    if (count <= NeighborIndexTraits<uint8_t>::MAX_POINTS
+        && indices.size() <= std::numeric_limits<NeighborIndexTraits<uint8_t>::Offset>::max()) {
+        topology.ownedCompactOffsets_.assign(offsets.begin(), offsets.end());
+        topology.ownedCompactIndices_.assign(indices.begin(), indices.end());
+        topology.setNeighbors<uint8_t>(topology.ownedCompactOffsets_, topology.ownedCompactIndices_);
+        topology.buildNeighborMasks();
+    }
+    else {
+        topology.ownedWideOffsets_ = std::move(offsets);
+        topology.ownedWideIndices_ = std::move(indices);
+        topology.setNeighbors<uint16_t>(topology.ownedWideOffsets_, topology.ownedWideIndices_);
+    }
+
+    // --- 3. Hop distances, for small topologies only ---
+    if (count <= MAX_HOP_TABLE_POINTS) {
+        topology.buildHopDistanceTable();
+    }
+    return topology;
+}
+
+void Topology::buildNeighborMasks() {
+    const size_t words = getMaskWords();
+    ownedNeighborMasks_.assign(keys_.size() * words, 0);
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        forEachNeighbor(i, [&](size_t neighbor) {
+            ownedNeighborMasks_[i * words + neighbor / 64] |= uint64_t{ 1 } << (neighbor % 64);
+        });
+    }
+    neighborMasks_ = Span<const uint64_t>(ownedNeighborMasks_.data(), ownedNeighborMasks_.size());
+}
+
+void Topology::buildHopDistanceTable() {
+    const size_t count = keys_.size();
+    ownedHopDistances_.assign(count * count, UNREACHABLE_HOPS);
+
+    // One breadth-first search per source point, walking the CSR neighbor lists.
+    std::vector<uint16_t> queue(count);
+    for (size_t source = 0; source < count; ++source) {
+        uint8_t* row = &ownedHopDistances_[source * count];
+        size_t head = 0;
+        size_t tail = 0;
+
+        row[source] = 0;
+        queue[tail++] = static_cast<uint16_t>(source);
+        while (head < tail) {
+            const size_t current = queue[head++];
+            const uint8_t hops = row[current];
+            if (hops + 1 >= UNREACHABLE_HOPS) continue;
+
+            forEachNeighbor(current, [&](size_t next) {
+                if (row[next] == UNREACHABLE_HOPS) {
+                    row[next] = static_cast<uint8_t>(hops + 1);
+                    queue[tail++] = static_cast<uint16_t>(next);
+                }
+            });
+        }
+    }
+    hopDistances_ = Span<const uint8_t>(ownedHopDistances_.data(), ownedHopDistances_.size());
+}
@@ -0,0 +1,194 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Lighting/Compositor.h"
+#include <cstring>
+
+// --- SIMD Availability ---
+// The SIMD kernels are only compiled on x86 targets, and can be disabled
+// entirely with RIPPLEFX_COMPOSITOR_SCALAR (e.g. to benchmark the fallback).
+#if !defined(RIPPLEFX_COMPOSITOR_SCALAR) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define RIPPLEFX_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions that ask for them,
+// which lets this file be built without -mavx2 and still carry the AVX2 path.
+#if defined(__GNUC__) || defined(__clang__)
+#define RIPPLEFX_TARGET(features) __attribute__((target(features)))
+#else
+#define RIPPLEFX_TARGET(features)
+#endif
+
+namespace {
+
+/**
+ * @brief Saturating add of every byte of two words (SWAR: SIMD within a register).
+ *
+ * The low 7 bits of each byte are summed without any carry crossing into the
+ * next byte. The top bit and the overflow are then reconstructed with logic
+ * operations, and overflowing bytes are forced to 0xFF.
+ */
+template<typename Word>
+inline Word addSaturateBytes(Word a, Word b) {
+    constexpr Word LOW_BITS = static_cast<Word>(0x7F7F7F7F7F7F7F7FULL);
+    constexpr Word HIGH_BITS = static_cast<Word>(0x8080808080808080ULL);
+
+    const Word sum = (a & LOW_BITS) + (b & LOW_BITS);
+    const Word result = sum ^ ((a ^ b) & HIGH_BITS);
+    const Word overflow = ((a & b) | ((a ^ b) & sum)) & HIGH_BITS;
+    return result | static_cast<Word>((overflow >> 7) * 0xFF);
+}
+
+#if defined(RIPPLEFX_X86_SIMD)
+bool cpuSupportsSse2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+    if (!osSavesAvx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+Compositor::Kernel detectKernel() {
+#if defined(RIPPLEFX_X86_SIMD)
+    if (cpuSupportsAvx2()) return Compositor::Kernel::AVX2;
+    if (cpuSupportsSse2()) return Compositor::Kernel::SSE2;
+#endif
+    return Compositor::Kernel::Scalar;
+}
+
+} // namespace
+
+Compositor::Kernel Compositor::activeKernel() {
+    // Detected once; function-local statics are initialized thread-safely.
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
+
+bool Compositor::isSupported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+#if defined(RIPPLEFX_X86_SIMD)
+    case Kernel::SSE2:
+        return cpuSupportsSse2();
+    case Kernel::AVX2:
+        return cpuSupportsAvx2();
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* Compositor::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::SSE2: return "SSE2";
+    case Kernel::AVX2: return "AVX2";
+    default: return "Scalar";
+    }
+}
+
+void Compositor::addSaturate(PackedColor* dst, const PackedColor* src, size_t count) {
+    addSaturate(activeKernel(), dst, src, count);
+}
+
+void Compositor::addSaturate(Span<Color> dst, Span<const Color> src) {
+    static_assert(sizeof(Color) == sizeof(PackedColor), "Color must have the packed RGBA8 layout.");
+
+    // The kernels only touch memory through memcpy and unaligned SIMD loads and
+    // stores, which may alias any object, so Color storage can be passed as is.
+    addSaturate(activeKernel(),
+        reinterpret_cast<PackedColor*>(dst.data()),
+        reinterpret_cast<const PackedColor*>(src.data()),
+        dst.size() < src.size() ? dst.size() : src.size());
+}
+
+void Compositor::addSaturate(Kernel kernel, PackedColor* dst, const PackedColor* src, size_t count) {
+    switch (kernel) {
+    case Kernel::AVX2:
+        addSaturateAvx2(dst, src, count);
+        break;
+    case Kernel::SSE2:
+        addSaturateSse2(dst, src, count);
+        break;
+    default:
+        addSaturateScalar(dst, src, count);
+        break;
+    }
+}
+
+void Compositor::addSaturateScalar(PackedColor* dst, const PackedColor* src, size_t count) {
+    size_t i = 0;
+
+    // Two pixels per 64-bit word. memcpy keeps the loads legal for any alignment
+    // and compiles down to plain moves.
+    for (; i + 2 <= count; i += 2) {
+        uint64_t a, b;
+        std::memcpy(&a, dst + i, sizeof(a));
+        std::memcpy(&b, src + i, sizeof(b));
+        a = addSaturateBytes<uint64_t>(a, b);
+        std::memcpy(dst + i, &a, sizeof(a));
+    }
+
+    if (i < count) {
+        uint32_t a, b;
+        std::memcpy(&a, dst + i, sizeof(a));
+        std::memcpy(&b, src + i, sizeof(b));
+        a = addSaturateBytes<uint32_t>(a, b);
+        std::memcpy(dst + i, &a, sizeof(a));
+    }
+}
+
+#if defined(RIPPLEFX_X86_SIMD)
+RIPPLEFX_TARGET("sse2")
+void Compositor::addSaturateSse2(PackedColor* dst, const PackedColor* src, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(a, b));
+    }
+    addSaturateScalar(dst + i, src + i, count - i);
+}
+
+RIPPLEFX_TARGET("avx2")
+void Compositor::addSaturateAvx2(PackedColor* dst, const PackedColor* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epu8(a, b));
+    }
+    addSaturateSse2(dst + i, src + i, count - i);
+}
+#else
+// Without SIMD support these are never selected, but keep them well-defined.
+void Compositor::addSaturateSse2(PackedColor* dst, const PackedColor* src, size_t count) {
+    addSaturateScalar(dst, src, count);
+}
+
+void Compositor::addSaturateAvx2(PackedColor* dst, const PackedColor* src, size_t count) {
+    addSaturateScalar(dst, src, count);
+}
+#endif
@@ -2,22 +2,110 @@
  * @author Michele Bisignano
  */
 #include "Core/Lighting/EffectPool.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
 
-EffectPool::EffectPool() {
-    // At the start, all memory slots are free.
-    // We fill our freeSlots_ vector with pointers to the start of each "room".
-    freeSlots_.reserve(MAX_ACTIVE_EFFECTS);
-    for (size_t i = 0; i < MAX_ACTIVE_EFFECTS; ++i) {
-        RippleEffect* slot = reinterpret_cast<RippleEffect*>(&memoryPool_[i * sizeof(RippleEffect)]);
-        freeSlots_.push_back(slot);
+EffectPool::EffectPool(std::initializer_list<SizeClass> sizeClasses) {
+    assert(sizeClasses.size() <= MAX_SIZE_CLASSES && "Too many size classes for the pool.");
+
+    // Normalize the configuration: round every slot up to the alignment (and to
+    // at least the size of a free-list link) and order classes from small to large.
+    std::array<SizeClass, MAX_SIZE_CLASSES> classes{};
+    for (const SizeClass& sizeClass : sizeClasses) {
+        if (slabCount_ == MAX_SIZE_CLASSES) break;
+        const size_t minimum = std::max(sizeClass.slotSize, sizeof(FreeSlot));
+        const SizeClass rounded{ (minimum + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN, sizeClass.slotCount };
+
+        // Insertion sort: there are at most MAX_SIZE_CLASSES entries.
+        size_t position = slabCount_++;
+        for (; position > 0 && classes[position - 1].slotSize > rounded.slotSize; --position) {
+            classes[position] = classes[position - 1];
+        }
+        classes[position] = rounded;
+    }
+
+    size_t totalBytes = 0;
+    for (size_t s = 0; s < slabCount_; ++s) {
+        totalBytes += classes[s].slotSize * classes[s].slotCount;
+    }
+
+    // The one and only allocation. operator new[] returns memory suitably aligned
+    // for any fundamental type, and every slot size is a multiple of SLOT_ALIGN.
+    memory_ = std::make_unique<std::byte[]>(totalBytes);
+
+    // Carve the block into slabs and thread each slab's free list through its slots.
+    std::byte* cursor = memory_.get();
+    for (size_t s = 0; s < slabCount_; ++s) {
+        Slab& slab = slabs_[s];
+        const size_t slotCount = classes[s].slotCount;
+
+        slab.slotSize = classes[s].slotSize;
+        slab.begin = cursor;
+        slab.end = cursor + slab.slotSize * slotCount;
+        cursor = slab.end;
+
+        // Push the slots in reverse so the lowest address is handed out first.
+        slab.freeList = nullptr;
+        for (size_t i = slotCount; i-- > 0;) {
+            FreeSlot* slot = new (slab.begin + i * slab.slotSize) FreeSlot{ slab.freeList };
+            slab.freeList = slot;
+        }
+        capacity_ += slotCount;
+    }
+}
+
+void* EffectPool::allocate(size_t size) {
+    // The smallest class that fits wins; larger classes absorb the overflow.
+    for (size_t s = 0; s < slabCount_; ++s) {
+        Slab& slab = slabs_[s];
+        if (slab.slotSize >= size && slab.freeList) {
+            FreeSlot* slot = slab.freeList;
+            slab.freeList = slot->next;
+            ++used_;
+            highWaterMark_ = std::max(highWaterMark_, used_);
+            return slot;
+        }
     }
+    ++rejected_;
+    return nullptr;
 }
 
-void EffectPool::destroy(RippleEffect* effect) {
-    if (effect) {
-        // Explicitly call the destructor of the object.
-        effect->~RippleEffect();
-        // Add the memory slot back to the list of available "rooms".
-        freeSlots_.push_back(effect);
+void EffectPool::destroy(IEffect* effect) {
+    if (!effect) return;
+
+    // Find the slab that owns this address. The effect may not start exactly at
+    // the beginning of its slot (e.g. with multiple inheritance), so round down.
+    std::byte* address = reinterpret_cast<std::byte*>(effect);
+    for (size_t s = 0; s < slabCount_; ++s) {
+        Slab& slab = slabs_[s];
+        if (address >= slab.begin && address < slab.end) {
+            std::byte* slotStart = slab.begin + static_cast<size_t>(address - slab.begin) / slab.slotSize * slab.slotSize;
+
+            // Explicitly call the (virtual) destructor of the object.
+            effect->~IEffect();
+
+            // Link the slot back in as the new head of the free list.
+            slab.freeList = new (slotStart) FreeSlot{ slab.freeList };
+            --used_;
+            return;
+        }
     }
-}
\ No newline at end of file
+    assert(false && "EffectPool::destroy() called with an effect from another allocator.");
+}
+
+size_t EffectPool::capacity() const {
+    return capacity_;
+}
+
+size_t EffectPool::size() const {
+    return used_;
+}
+
+size_t EffectPool::highWaterMark() const {
+    return highWaterMark_;
+}
+
+uint64_t EffectPool::rejectedCount() const {
+    return rejected_;
+}
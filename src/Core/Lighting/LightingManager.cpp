@@ -1,65 +1,441 @@
 #include "Core/Lighting/LightingManager.h"
+#include "Core/Effects/RippleEffect.h"
+#include "Core/Effects/SeekableRippleEffect.h"
+#include "Core/Effects/SolidColorEffect.h"
+#include "Core/Effects/SparksEffect.h"
+#include "Core/Effects/SpectrumEffect.h"
+#include "Core/Util/Profiler.h"
 #include <algorithm>
+#include <utility>
 
-LightingManager::LightingManager(Keyboard* keyboard)
-    : keyboard_(keyboard)
+namespace {
+
+// The slot size of an effect on the manager's topology, if it has one.
+template<typename T>
+size_t slotSizeOn(const Topology* topology) {
+    return topology ? EffectPool::slotSizeFor<T>(*topology) : EffectPool::slotSizeFor<T>();
+}
+
+size_t keyCountOf(const Topology* topology) {
+    return topology ? topology->getKeys().size() : 0;
+}
+
+} // namespace
+
+LightingManager::LightingManager(Topology* topology, size_t maxActiveEffects, EvictionPolicy evictionPolicy, SharedEffects sharedEffects)
+    : topology_(topology),
+      maxActiveEffects_(maxActiveEffects),
+      evictionPolicy_(evictionPolicy),
+      sharedEffects_(sharedEffects),
+      // One size class per built-in effect footprint, so a small effect never
+      // occupies a large slot while large ones are waiting for memory. The
+      // shared effects (the ripple field, the sparks and the spectrum) get one
+      // slot each in classes of their own: the other effects never outnumber
+      // their own classes, so they never take those slots. The optional ones
+      // get no slot unless asked for. Effects with per-key state get slots
+      // sized for this topology.
+      effectPool_({
+          { std::max(EffectPool::slotSizeFor<SeekableRippleEffect>(), EffectPool::slotSizeFor<SolidColorEffect>()), maxActiveEffects },
+          { slotSizeOn<RippleEffect>(topology), maxActiveEffects },
+          { slotSizeOn<RippleFieldEffect>(topology), 1 },
+          { slotSizeOn<SparksEffect>(topology), includes(sharedEffects, SharedEffects::Sparks) ? 1u : 0u },
+          { slotSizeOn<SpectrumEffect>(topology), includes(sharedEffects, SharedEffects::Spectrum) ? 1u : 0u } }),
+      layeredKeys_(keyCountOf(topology)),
+      litKeys_(keyCountOf(topology)),
+      previousLitKeys_(keyCountOf(topology)),
+      dirtyKeys_(keyCountOf(topology))
 {
+    activeEffects_.reserve(maxActiveEffects_ + SHARED_EFFECT_COUNT);
+
     // Initialize the framebuffer to the correct size, filled with black
-    if (keyboard_) {
-        frameBuffer_.resize(keyboard_->getKeys().size(), Color(0, 0, 0));
+    if (topology_) {
+        frameBuffer_.resize(topology_->getKeys().size(), Color(0, 0, 0));
+        previousFrame_.resize(topology_->getKeys().size(), Color(0, 0, 0));
+        for (Layer& layer : layers_) {
+            layer.pixels.resize(topology_->getKeys().size(), Color(0, 0, 0, 0));
+            layer.coverage = KeySet(topology_->getKeys().size());
+        }
     }
 }
 
 void LightingManager::update() {
-    if (!keyboard_) return;
+    if (!topology_) return;
 
-    // --- 1. Update all active effects ---
-    for (auto& effect : activeEffects_) {
-        effect->update();
+    // --- 0. Idle fast path ---
+    // Nothing is running and the last frame was already all black: nothing can change.
+    dirtyKeys_.clear();
+    RIPPLEFX_PROFILE_POOL(effectPool_);
+    if (isIdle()) {
+        return;
     }
 
-    // --- 2. Remove any effects that have finished ---
-    // The removal logic changes because we are using raw pointers and a pool.
-    // An explicit iterator loop is the clearest way to handle this.
-    auto it = activeEffects_.begin();
-    while (it != activeEffects_.end()) {
-        if ((*it)->isFinished()) {
-            // Return the effect's memory to the pool.
-            // A cast is necessary because destroy() expects the concrete type.
-            effectPool_.destroy(static_cast<RippleEffect*>(*it));
+    {
+        RIPPLEFX_PROFILE_SCOPE(ProfileStage::EffectUpdate);
 
-            // Remove the pointer from the vector.
-            // erase() returns an iterator to the next valid element.
-            it = activeEffects_.erase(it);
+        // --- 1. Update all active effects ---
+        for (auto& active : activeEffects_) {
+            active.effect->update();
         }
-        else {
-            // If the effect is not finished, just advance to the next one.
-            ++it;
+
+        // --- 2. Remove any effects that have finished ---
+        // Swap-and-pop: each removal is O(1), so the whole pass stays linear.
+        // The index is only advanced when the slot keeps its effect, since a
+        // retired slot now holds the former last element, which still needs checking.
+        size_t i = 0;
+        while (i < activeEffects_.size()) {
+            if (activeEffects_[i].effect->isFinished()) {
+                retire(i);
+            }
+            else {
+                ++i;
+            }
         }
     }
 
+    RIPPLEFX_PROFILE_SCOPE(ProfileStage::Composite);
+
     // --- 3. Render the final frame ---
-    // Start with a black frame
-    frameBuffer_.assign(keyboard_->getKeys().size(), Color(0, 0, 0));
+    // Only the keys lit in the previous frame can be non-black, so resetting
+    // those is enough to start from a black frame.
+    std::swap(litKeys_, previousLitKeys_);
+    litKeys_.clear();
+    for (uint16_t i : previousLitKeys_) {
+        frameBuffer_[i] = Color(0, 0, 0);
+    }
+
+    // The lowest layer in use sits on a black frame, where Add, Max and
+    // Replace all leave just the layer: its effects go straight into the
+    // frame. With only that layer in use (the default), nothing else is needed.
+    size_t baseLayer = 0;
+    while (baseLayer < MAX_LAYERS && layers_[baseLayer].effectCount == 0) {
+        ++baseLayer;
+    }
+    const bool baseInPlace = baseLayer < MAX_LAYERS && rendersInPlace(layers_[baseLayer]);
 
-    const auto& keys = keyboard_->getKeys();
-    for (size_t i = 0; i < keys.size(); ++i) {
-        // For each key, additively blend the colors from all active effects.
-        for (const auto& effect : activeEffects_) {
-            Color effectColor = effect->getColorForKey(keys[i]);
-            // Use the new 'add' method to layer the lights.
-            frameBuffer_[i] = frameBuffer_[i].add(effectColor);
+    // Each effect additively blends its own lit keys in a single batched call
+    // and reports them, so untouched keys are never visited. Effects on the
+    // other layers render into their layer's scratch buffer instead.
+    const auto& keys = topology_->getKeys();
+    for (const auto& active : activeEffects_) {
+        if (baseInPlace && active.layer == baseLayer) {
+            active.effect->composite(keys, frameBuffer_, litKeys_);
+        }
+        else {
+            Layer& layer = layers_[active.layer];
+            active.effect->composite(keys, layer.pixels, layer.coverage);
         }
     }
+    blendLayers(baseInPlace ? baseLayer + 1 : baseLayer);
+
+    // --- 4. Track changed keys ---
+    // A key can only have changed if it was lit before or is lit now.
+    // An attached LED encoder is updated here too, so the wire buffer never
+    // needs a pass of its own.
+    auto markIfChanged = [this](uint16_t i) {
+        if (frameBuffer_[i] != previousFrame_[i]) {
+            previousFrame_[i] = frameBuffer_[i];
+            dirtyKeys_.insert(i);
+            if (ledEncoder_) {
+                ledEncoder_->encodeKey(i, frameBuffer_[i]);
+            }
+        }
+    };
+    for (uint16_t i : previousLitKeys_) markIfChanged(i);
+    for (uint16_t i : litKeys_) markIfChanged(i);
 }
 
-void LightingManager::addRippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime) {
-    RippleEffect* new_effect = effectPool_.create(startKey, color, stepDuration, propagationDelay, maxLifetime);
+void LightingManager::blendLayers(size_t firstLayer) {
+    // Collect the layers with anything to show, bottom to top. Empty layers
+    // drop out here and are never visited again.
+    std::array<Layer*, MAX_LAYERS> visible{};
+    size_t visibleCount = 0;
+    bool allAdd = true;
+    for (size_t l = firstLayer; l < MAX_LAYERS; ++l) {
+        Layer& layer = layers_[l];
+        if (layer.coverage.empty()) {
+            continue;
+        }
+        visible[visibleCount++] = &layer;
+        allAdd = allAdd && layer.mode == BlendMode::Add && layer.opacity == 255;
+    }
+    if (visibleCount == 0) {
+        return;
+    }
+
+    if (allAdd) {
+        // Opaque Add layers are a plain saturating sum, in any order, and their
+        // scratch buffers are transparent outside their coverage. A layer
+        // covering a large part of the keys is summed into the frame whole,
+        // with the packed SIMD kernel; the others key by key.
+        for (size_t v = 0; v < visibleCount; ++v) {
+            const Layer& layer = *visible[v];
+            if (layer.coverage.size() * DENSE_LAYER_FRACTION >= frameBuffer_.size()) {
+                Compositor::addSaturate(frameBuffer_, layer.pixels);
+            }
+            else {
+                for (uint16_t i : layer.coverage) {
+                    frameBuffer_[i] = frameBuffer_[i].add(layer.pixels[i]);
+                }
+            }
+            for (uint16_t i : layer.coverage) {
+                litKeys_.insert(i);
+            }
+        }
+    }
+    else {
+        // One fused pass: every key any layer covers is read once, blended
+        // through all the layers that cover it, and written once.
+        layeredKeys_.clear();
+        for (size_t v = 0; v < visibleCount; ++v) {
+            for (uint16_t i : visible[v]->coverage) {
+                layeredKeys_.insert(i);
+            }
+        }
+        for (uint16_t i : layeredKeys_) {
+            Color color = frameBuffer_[i];
+            for (size_t v = 0; v < visibleCount; ++v) {
+                const Layer& layer = *visible[v];
+                if (layer.coverage.contains(i)) {
+                    color = Compositor::blendPixel(layer.mode, color, layer.pixels[i], layer.opacity);
+                }
+            }
+            frameBuffer_[i] = color;
+            litKeys_.insert(i);
+        }
+    }
+
+    // Leave the scratch buffers transparent again for the next frame.
+    for (size_t v = 0; v < visibleCount; ++v) {
+        Layer& layer = *visible[v];
+        for (uint16_t i : layer.coverage) {
+            layer.pixels[i] = Color(0, 0, 0, 0);
+        }
+        layer.coverage.clear();
+    }
+}
+
+bool LightingManager::rendersInPlace(const Layer& layer) {
+    return layer.opacity == 255
+        && (layer.mode == BlendMode::Add || layer.mode == BlendMode::Max || layer.mode == BlendMode::Replace);
+}
+
+template<typename T, typename... Args>
+void LightingManager::addEffect(int priority, size_t layer, Args&&... args) {
+    if (!topology_ || layer >= MAX_LAYERS || !makeRoom(priority)) return;
+
+    T* new_effect = effectPool_.create<T>(*topology_, std::forward<Args>(args)...);
     if (new_effect) {
-        activeEffects_.push_back(static_cast<IEffect*>(new_effect));
+        activeEffects_.push_back({ new_effect, nextSerial_++, priority, static_cast<uint8_t>(layer) });
+        layers_[layer].effectCount++;
+    }
+}
+
+bool LightingManager::makeRoom(int priority) {
+    if (countedEffects() < maxActiveEffects_) {
+        return true;
+    }
+    if (countedEffects() == 0 || evictionPolicy_ == EvictionPolicy::DropNew) {
+        return false;
+    }
+
+    // Only reached when the manager is full, so a linear scan is fine here.
+    // Serial differences are compared instead of raw serials so that the
+    // order stays correct when the counter wraps around.
+    auto isOlder = [this](const ActiveEffect& a, const ActiveEffect& b) {
+        return static_cast<int32_t>(a.serial - nextSerial_) < static_cast<int32_t>(b.serial - nextSerial_);
+    };
+    // The shared effects hold many ripples or sparks at once, or a live
+    // analyzer, and are never victims.
+    size_t victim = 0;
+    while (isShared(activeEffects_[victim].effect)) {
+        ++victim;
+    }
+    for (size_t i = victim + 1; i < activeEffects_.size(); ++i) {
+        const ActiveEffect& candidate = activeEffects_[i];
+        const ActiveEffect& best = activeEffects_[victim];
+        if (isShared(candidate.effect)) {
+            continue;
+        }
+        bool better = false;
+        switch (evictionPolicy_) {
+        case EvictionPolicy::StealDimmest: {
+            const uint8_t candidateIntensity = candidate.effect->getIntensity();
+            const uint8_t bestIntensity = best.effect->getIntensity();
+            better = candidateIntensity < bestIntensity || (candidateIntensity == bestIntensity && isOlder(candidate, best));
+            break;
+        }
+        case EvictionPolicy::StealLowestPriority:
+            better = candidate.priority < best.priority || (candidate.priority == best.priority && isOlder(candidate, best));
+            break;
+        default:
+            better = isOlder(candidate, best);
+            break;
+        }
+        if (better) {
+            victim = i;
+        }
+    }
+
+    if (evictionPolicy_ == EvictionPolicy::StealLowestPriority && activeEffects_[victim].priority > priority) {
+        return false;
+    }
+    retire(victim);
+    return true;
+}
+
+void LightingManager::retire(size_t index) {
+    // Return the effect's memory to the pool.
+    effectPool_.destroy(activeEffects_[index].effect);
+    layers_[activeEffects_[index].layer].effectCount--;
+    if (activeEffects_[index].effect == rippleField_) {
+        rippleField_ = nullptr;
+    }
+    if (activeEffects_[index].effect == sparks_) {
+        sparks_ = nullptr;
+    }
+    if (activeEffects_[index].effect == spectrum_) {
+        spectrum_ = nullptr;
+    }
+
+    activeEffects_[index] = activeEffects_.back();
+    activeEffects_.pop_back();
+}
+
+void LightingManager::addRippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime, int priority, size_t layer) {
+    addEffect<RippleEffect>(priority, layer, startKey, color, stepDuration, propagationDelay, maxLifetime);
+}
+
+void LightingManager::addSeekableRippleEffect(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime, int priority, size_t layer) {
+    if (topology_ && !topology_->hasHopDistances()) {
+        addEffect<RippleEffect>(priority, layer, startKey, color, stepDuration, propagationDelay, maxLifetime);
+        return;
+    }
+    addEffect<SeekableRippleEffect>(priority, layer, startKey, color, stepDuration, propagationDelay, maxLifetime);
+}
+
+size_t LightingManager::countedEffects() const {
+    return activeEffects_.size() - (rippleField_ ? 1 : 0) - (sparks_ ? 1 : 0) - (spectrum_ ? 1 : 0);
+}
+
+bool LightingManager::isShared(const IEffect* effect) const {
+    return effect == rippleField_ || effect == sparks_ || effect == spectrum_;
+}
+
+template<typename T>
+T* LightingManager::activateShared(T*& shared, uint8_t layer) {
+    if (!shared) {
+        // Its slot is reserved, so this cannot fail.
+        shared = effectPool_.create<T>(*topology_);
+        activeEffects_.push_back({ shared, nextSerial_++, 0, layer });
+        layers_[layer].effectCount++;
+    }
+    return shared;
+}
+
+void LightingManager::moveToLayer(const IEffect* effect, size_t layer) {
+    for (auto& active : activeEffects_) {
+        if (active.effect == effect) {
+            layers_[active.layer].effectCount--;
+            layers_[layer].effectCount++;
+            active.layer = static_cast<uint8_t>(layer);
+        }
+    }
+}
+
+void LightingManager::addFieldRipple(const Key& startKey, const Color& color, int stepDuration, int propagationDelay, int maxLifetime) {
+    if (!topology_) return;
+    activateShared(rippleField_, rippleFieldLayer_)->addSource(startKey, color, stepDuration, propagationDelay, maxLifetime);
+}
+
+void LightingManager::setRippleFieldLayer(size_t layer) {
+    if (layer >= MAX_LAYERS) return;
+    if (rippleField_) {
+        moveToLayer(rippleField_, layer);
+    }
+    rippleFieldLayer_ = static_cast<uint8_t>(layer);
+}
+
+size_t LightingManager::addSparks(const Key& origin, const Color& color, size_t count, int lifetime) {
+    if (!topology_ || count == 0 || !includes(sharedEffects_, SharedEffects::Sparks)) return 0;
+    return activateShared(sparks_, sparksLayer_)->emit(origin, color, count, lifetime);
+}
+
+void LightingManager::setSparksLayer(size_t layer) {
+    if (layer >= MAX_LAYERS) return;
+    if (sparks_) {
+        moveToLayer(sparks_, layer);
     }
+    sparksLayer_ = static_cast<uint8_t>(layer);
+}
+
+void LightingManager::addSpectrum(PcmRing& source, const Color& color) {
+    if (!topology_ || !includes(sharedEffects_, SharedEffects::Spectrum)) return;
+    activateShared(spectrum_, spectrumLayer_)->attach(source, color);
+}
+
+void LightingManager::setSpectrumLayer(size_t layer) {
+    if (layer >= MAX_LAYERS) return;
+    if (spectrum_) {
+        moveToLayer(spectrum_, layer);
+    }
+    spectrumLayer_ = static_cast<uint8_t>(layer);
+}
+
+void LightingManager::addSolidColorEffect(const Color& color, int maxLifetime, int priority, size_t layer) {
+    addEffect<SolidColorEffect>(priority, layer, color, maxLifetime);
+}
+
+void LightingManager::clearLayer(size_t layer) {
+    size_t i = 0;
+    while (i < activeEffects_.size()) {
+        if (activeEffects_[i].layer == layer) {
+            retire(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+void LightingManager::setLayerBlendMode(size_t layer, BlendMode mode, uint8_t opacity) {
+    if (layer >= MAX_LAYERS) return;
+    layers_[layer].mode = mode;
+    layers_[layer].opacity = opacity;
+}
+
+BlendMode LightingManager::getLayerBlendMode(size_t layer) const {
+    if (layer >= MAX_LAYERS) return BlendMode::Add;
+    return layers_[layer].mode;
+}
+
+uint8_t LightingManager::getLayerOpacity(size_t layer) const {
+    if (layer >= MAX_LAYERS) return 255;
+    return layers_[layer].opacity;
+}
+
+void LightingManager::setEvictionPolicy(EvictionPolicy policy) {
+    evictionPolicy_ = policy;
+}
+
+EvictionPolicy LightingManager::getEvictionPolicy() const {
+    return evictionPolicy_;
 }
 
 const std::vector<Color>& LightingManager::getFrameBuffer() const {
     return frameBuffer_;
+}
+
+const KeySet& LightingManager::getDirtyKeys() const {
+    return dirtyKeys_;
+}
+
+void LightingManager::setLedEncoder(LedEncoder* encoder) {
+    ledEncoder_ = encoder;
+    if (ledEncoder_) {
+        ledEncoder_->encodeAll(frameBuffer_);
+    }
+}
+
+bool LightingManager::isIdle() const {
+    return activeEffects_.empty() && litKeys_.empty();
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Lighting/RippleSpawner.h"
+#include <algorithm>
+
+RippleSpawner::RippleSpawner(LightingManager& lightingManager, uint32_t startTimestampMs, uint32_t seed)
+    : lightingManager_(lightingManager),
+    lastPressMs_(startTimestampMs),
+    rng_(seed)
+{
+}
+
+void RippleSpawner::onKeyPress(const Key& key, uint32_t timestampMs) {
+    // Unsigned subtraction stays correct across a wrap of the millisecond counter.
+    const uint32_t time_since_last_press = timestampMs - lastPressMs_;
+    lastPressMs_ = timestampMs;
+
+    // Use 'long long' for the intermediate calculation. This is the safest approach
+    // to prevent an integer overflow bug if the time since the last press is very long.
+    long long lifetime_ms = (static_cast<long long>(time_since_last_press) << 1);
+
+    // Clamp the value to a sensible range. The 'LL' suffix ensures the numbers
+    // are treated as long long, preventing compiler warnings.
+    lifetime_ms = std::max(500LL, std::min(7000LL, lifetime_ms));
+
+    // Convert lifetime in milliseconds to frames using a fast bit shift (division by 16).
+    const int maxLifetime = static_cast<int>(lifetime_ms >> 4);
+
+    // Map typing speed to wave propagation speed.
+    int propagationDelay = 5;
+    if (time_since_last_press < 150) propagationDelay = 1;
+    else if (time_since_last_press < 250) propagationDelay = 2;
+    else if (time_since_last_press < 350) propagationDelay = 3;
+    else if (time_since_last_press < 500) propagationDelay = 4;
+
+    // Calculate fade duration using a fast bit shift (division by 8).
+    const int stepDuration = std::max(1, maxLifetime >> 3);
+
+    const Color color = Color::randomColor(rng_);
+    if (sparksPerPress_ > 0) {
+        // Sparks burn out in half the ripple's lifetime.
+        lightingManager_.addSparks(key, color, sparksPerPress_, maxLifetime >> 1);
+    }
+    if (useRippleField_) {
+        lightingManager_.addFieldRipple(key, color, stepDuration, propagationDelay, maxLifetime);
+        return;
+    }
+    lightingManager_.addRippleEffect(
+        key,
+        color,
+        stepDuration,
+        propagationDelay,
+        maxLifetime
+    );
+}
+
+void RippleSpawner::setUseRippleField(bool useRippleField) {
+    useRippleField_ = useRippleField;
+}
+
+void RippleSpawner::setSparksPerPress(size_t sparksPerPress) {
+    sparksPerPress_ = sparksPerPress;
+}
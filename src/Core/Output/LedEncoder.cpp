@@ -0,0 +1,44 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Output/LedEncoder.h"
+#include <algorithm>
+#include <cassert>
+
+LedEncoder::LedEncoder(const WireFormat& format, size_t keyCount, Span<const uint16_t> ledForKey)
+    : format_(format),
+    pixelOffsets_(keyCount),
+    buffer_(format.frameBytes(keyCount), 0)
+{
+    assert((ledForKey.empty() || ledForKey.size() == keyCount) && "One LED position is needed per key.");
+
+    const size_t header = format_.headerBytes();
+    for (size_t i = 0; i < keyCount; ++i) {
+        const size_t led = ledForKey.empty() ? i : ledForKey[i];
+        assert(led < keyCount && "LED position out of range.");
+        pixelOffsets_[i] = static_cast<uint32_t>(header + led * format_.bytesPerLed());
+    }
+
+    // The header (all zeros for APA102) is already in place; the trailer is
+    // fixed too, so only the pixels change from now on.
+    const size_t trailerStart = header + keyCount * format_.bytesPerLed();
+    std::fill(buffer_.begin() + static_cast<std::ptrdiff_t>(trailerStart), buffer_.end(), uint8_t{ 0xFF });
+
+    // Start from black, with any per-pixel constant bits (e.g. APA102 brightness) set.
+    for (size_t i = 0; i < keyCount; ++i) {
+        encodeKey(i, Color(0, 0, 0));
+    }
+}
+
+void LedEncoder::encodeAll(Span<const Color> frame) {
+    const size_t count = std::min(frame.size(), pixelOffsets_.size());
+    for (size_t i = 0; i < count; ++i) {
+        encodeKey(i, frame[i]);
+    }
+}
+
+void LedEncoder::encodeChanges(Span<const Color> frame, const KeySet& dirtyKeys) {
+    for (uint16_t i : dirtyKeys) {
+        encodeKey(i, frame[i]);
+    }
+}
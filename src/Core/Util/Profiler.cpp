@@ -0,0 +1,141 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Core/Util/Profiler.h"
+#include <cstdio>
+
+namespace {
+
+const char* const STAGE_NAMES[] = { "InputPoll", "EffectUpdate", "Composite", "Render" };
+static_assert(sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) == static_cast<size_t>(ProfileStage::Count),
+    "Every ProfileStage needs a name.");
+
+const char* const PACED_LOOP_NAMES[] = { "Frame", "Input", "Simulation" };
+static_assert(sizeof(PACED_LOOP_NAMES) / sizeof(PACED_LOOP_NAMES[0]) == static_cast<size_t>(PacedLoop::Count),
+    "Every PacedLoop needs a name.");
+
+// How often the reporter thread checks for a dump request.
+constexpr auto REPORTER_CHECK_INTERVAL = std::chrono::milliseconds(100);
+
+} // namespace
+
+uint64_t LatencyHistogram::Snapshot::percentileNs(double percentile) const {
+    if (count == 0) return 0;
+
+    // The smallest bucket that holds the requested share of the samples.
+    const double target = static_cast<double>(count) * percentile / 100.0;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+        seen += buckets[b];
+        if (static_cast<double>(seen) >= target && seen > 0) {
+            // The upper bound of bucket b, but never beyond the largest sample.
+            const uint64_t upper = b == 0 ? 0 : (uint64_t{ 1 } << b) - 1;
+            return upper < maxNs ? upper : maxNs;
+        }
+    }
+    return maxNs;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot result;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+        result.buckets[b] = buckets_[b].load(std::memory_order_relaxed);
+        result.count += result.buckets[b];
+    }
+    // The count is the sum of the buckets, so percentiles stay consistent even
+    // if a sample is being recorded meanwhile.
+    result.totalNs = totalNs_.load(std::memory_order_relaxed);
+    result.maxNs = maxNs_.load(std::memory_order_relaxed);
+    return result;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    totalNs_.store(0, std::memory_order_relaxed);
+    maxNs_.store(0, std::memory_order_relaxed);
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::dump(std::ostream& out) const {
+    // printf-style formatting keeps the columns aligned without touching the stream's flags.
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %10s %10s %10s %10s %10s\n", "stage (us)", "count", "mean", "p50", "p99", "max");
+    out << "--- RippleFX stats ---\n" << line;
+
+    for (size_t s = 0; s < stages_.size(); ++s) {
+        const LatencyHistogram::Snapshot snapshot = stages_[s].snapshot();
+        const double mean = snapshot.count == 0 ? 0.0 : static_cast<double>(snapshot.totalNs) / static_cast<double>(snapshot.count);
+        std::snprintf(line, sizeof(line), "%-14s %10llu %10.2f %10.2f %10.2f %10.2f\n",
+            STAGE_NAMES[s],
+            static_cast<unsigned long long>(snapshot.count),
+            mean / 1000.0,
+            static_cast<double>(snapshot.percentileNs(50.0)) / 1000.0,
+            static_cast<double>(snapshot.percentileNs(99.0)) / 1000.0,
+            static_cast<double>(snapshot.maxNs) / 1000.0);
+        out << line;
+    }
+
+    std::snprintf(line, sizeof(line), "EffectPool: %zu/%zu slots in use, high-water mark %zu, %llu rejected\n",
+        poolInUse_.load(std::memory_order_relaxed),
+        poolCapacity_.load(std::memory_order_relaxed),
+        poolHighWaterMark_.load(std::memory_order_relaxed),
+        static_cast<unsigned long long>(poolRejected_.load(std::memory_order_relaxed)));
+    out << line;
+
+    // Only the loops that ran: which ones depends on the mode.
+    for (size_t l = 0; l < pacers_.size(); ++l) {
+        const uint64_t frames = pacers_[l].frames.load(std::memory_order_relaxed);
+        if (frames == 0) continue;
+        std::snprintf(line, sizeof(line), "FramePacer %-10s: %llu frames, %llu missed deadlines, max jitter %.2f us\n",
+            PACED_LOOP_NAMES[l],
+            static_cast<unsigned long long>(frames),
+            static_cast<unsigned long long>(pacers_[l].missedDeadlines.load(std::memory_order_relaxed)),
+            static_cast<double>(pacers_[l].maxJitterNs.load(std::memory_order_relaxed)) / 1000.0);
+        out << line;
+    }
+    out << std::flush;
+}
+
+void Profiler::reset() {
+    for (auto& histogram : stages_) {
+        histogram.reset();
+    }
+}
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+
+StatsReporter::StatsReporter(std::ostream& out, std::chrono::seconds interval)
+    : out_(out),
+    interval_(interval),
+    thread_(&StatsReporter::run, this)
+{
+}
+
+StatsReporter::~StatsReporter() {
+    running_.store(false, std::memory_order_relaxed);
+    thread_.join();
+}
+
+void StatsReporter::run() {
+    auto nextDump = Profiler::Clock::now() + interval_;
+    while (running_.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(REPORTER_CHECK_INTERVAL);
+
+        bool due = dumpRequested_.exchange(false, std::memory_order_relaxed);
+        if (interval_.count() > 0 && Profiler::Clock::now() >= nextDump) {
+            nextDump += interval_;
+            due = true;
+        }
+        if (due) {
+            Profiler::instance().dump(out_);
+        }
+    }
+}
+
+#endif
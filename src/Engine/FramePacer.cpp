@@ -0,0 +1,100 @@
+/**
+ * @author Michele Bisignano
+ */
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+
+#include "Engine/FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+namespace {
+
+// How long before a deadline to switch from sleeping to spinning. Linux timers
+// wake within tens of microseconds; the default Windows timer is far coarser.
+#if defined(_WIN32)
+constexpr std::chrono::nanoseconds DEFAULT_SPIN_THRESHOLD = std::chrono::milliseconds(2);
+#else
+constexpr std::chrono::nanoseconds DEFAULT_SPIN_THRESHOLD = std::chrono::microseconds(200);
+#endif
+
+std::chrono::nanoseconds periodForFps(int targetFps) {
+    return std::chrono::nanoseconds(1000000000LL / std::max(1, targetFps));
+}
+
+} // namespace
+
+FramePacer::FramePacer(int targetFps)
+    : period_(periodForFps(targetFps)),
+    spinThreshold_(DEFAULT_SPIN_THRESHOLD),
+    deadline_(Clock::now() + period_)
+{
+}
+
+FramePacer::FramePacer(std::chrono::nanoseconds period)
+    : period_(std::max(period, std::chrono::nanoseconds(1))),
+    spinThreshold_(DEFAULT_SPIN_THRESHOLD),
+    deadline_(Clock::now() + period_)
+{
+}
+
+void FramePacer::setTargetFps(int targetFps) {
+    period_ = periodForFps(targetFps);
+    deadline_ = Clock::now() + period_;
+}
+
+void FramePacer::resync() {
+    resynced_ = true;
+}
+
+void FramePacer::wait() {
+    ++stats_.frames;
+
+    Clock::time_point now = Clock::now();
+    if (resynced_) {
+        resynced_ = false;
+        deadline_ = now + period_;
+        return;
+    }
+    if (now > deadline_) {
+        // Late already: run this frame right away. If a whole period or more was
+        // lost, restart the schedule rather than rushing through the backlog.
+        ++stats_.missedDeadlines;
+        deadline_ = (now - deadline_ >= period_) ? now + period_ : deadline_ + period_;
+        return;
+    }
+
+    // --- 1. Sleep through most of the frame ---
+    if (deadline_ - now > spinThreshold_) {
+        sleepUntil(deadline_ - spinThreshold_);
+    }
+
+    // --- 2. Spin through the rest ---
+    do {
+        now = Clock::now();
+    } while (now < deadline_);
+
+    stats_.maxJitter = std::max(stats_.maxJitter, std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline_));
+    deadline_ += period_;
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline) {
+#if defined(__linux__)
+    // steady_clock is CLOCK_MONOTONIC on Linux, so its time points convert directly.
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    timespec target;
+    target.tv_sec = static_cast<time_t>(sinceEpoch / 1000000000LL);
+    target.tv_nsec = static_cast<long>(sinceEpoch % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+        // An absolute deadline makes retrying after a signal exact.
+    }
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+
+#endif
@@ -0,0 +1,191 @@
+/**
+ * @author Michele Bisignano
+ */
+#include "Engine/Pipeline.h"
+#include "Core/Util/Profiler.h"
+
+Pipeline::Pipeline(const Topology& topology, IInputSource& input, IHardware& hardware, LightingManager& lightingManager,
+    RippleSpawner& spawner, std::chrono::nanoseconds frameDuration)
+    : topology_(topology),
+    input_(input),
+    hardware_(hardware),
+    lightingManager_(lightingManager),
+    spawner_(spawner),
+    frameDuration_(frameDuration)
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+    , frames_(std::vector<Color>(topology.getKeys().size(), Color(0, 0, 0))),
+    sentFrame_(topology.getKeys().size(), Color(0, 0, 0)),
+    changedKeys_(topology.getKeys().size())
+#endif
+{
+}
+
+Pipeline::~Pipeline() {
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+    stop();
+#endif
+}
+
+void Pipeline::runFrame(uint32_t timestampMs) {
+    // --- 1. Input Handling ---
+    {
+        RIPPLEFX_PROFILE_SCOPE(ProfileStage::InputPoll);
+        input_.pollEvents(events_, timestampMs);
+    }
+    handleKeyEvents();
+
+    // --- 2. Logic Update ---
+    lightingManager_.update();
+
+    // --- 3. Rendering ---
+    // Only frames with changed keys reach the device.
+    RIPPLEFX_PROFILE_SCOPE(ProfileStage::Render);
+    hardware_.renderChanges(lightingManager_.getFrameBuffer(), lightingManager_.getDirtyKeys());
+}
+
+bool Pipeline::isIdle() const {
+    return lightingManager_.isIdle() && events_.empty();
+}
+
+void Pipeline::handleKeyEvents() {
+    const auto keys = topology_.getKeys();
+
+    // Every press counts, even one released again within the same frame, and
+    // ripples are timed by when the key went down rather than by this frame.
+    KeyEvent event;
+    while (events_.tryPop(event)) {
+        if (event.action == KeyAction::Press && event.keyIndex < keys.size()) {
+            spawner_.onKeyPress(keys[event.keyIndex], event.timestampMs);
+        }
+    }
+}
+
+#if !defined(RIPPLEFX_SINGLE_THREADED)
+
+bool Pipeline::waitForInput() {
+    const auto start = std::chrono::steady_clock::now();
+    if (!input_.waitForEvents(IDLE_WAIT_TIMEOUT_MS)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_POLL_INTERVAL_MS));
+    }
+    return std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(IDLE_POLL_INTERVAL_MS);
+}
+
+void Pipeline::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    startTime_ = std::chrono::steady_clock::now();
+    inputThread_ = std::thread(&Pipeline::inputStage, this);
+    simulationThread_ = std::thread(&Pipeline::simulationStage, this);
+    outputThread_ = std::thread(&Pipeline::outputStage, this);
+}
+
+void Pipeline::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    { std::lock_guard<std::mutex> lock(frameReadyMutex_); }
+    frameReady_.notify_all();
+    { std::lock_guard<std::mutex> lock(inputReadyMutex_); }
+    inputReady_.notify_all();
+    inputThread_.join();
+    simulationThread_.join();
+    outputThread_.join();
+}
+
+bool Pipeline::isRunning() const {
+    return running_.load();
+}
+
+uint32_t Pipeline::elapsedMs() const {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime_).count());
+}
+
+void Pipeline::inputStage() {
+    FramePacer pacer(frameDuration_);
+    while (running_.load(std::memory_order_relaxed)) {
+        pacer.wait();
+        RIPPLEFX_PROFILE_PACER(PacedLoop::Input, pacer);
+        {
+            RIPPLEFX_PROFILE_SCOPE(ProfileStage::InputPoll);
+            input_.pollEvents(events_, elapsedMs());
+        }
+
+        if (!events_.empty()) {
+            { std::lock_guard<std::mutex> lock(inputReadyMutex_); }
+            inputReady_.notify_one();
+        }
+        else if (idle_.load(std::memory_order_relaxed)) {
+            if (waitForInput()) {
+                pacer.resync();
+            }
+        }
+    }
+}
+
+void Pipeline::simulationStage() {
+    FramePacer pacer(frameDuration_);
+    while (running_.load(std::memory_order_relaxed)) {
+        pacer.wait();
+        RIPPLEFX_PROFILE_PACER(PacedLoop::Simulation, pacer);
+        handleKeyEvents();
+        lightingManager_.update();
+
+        // An unchanged frame is not published, so the output thread has nothing to diff.
+        if (!lightingManager_.getDirtyKeys().empty()) {
+            // Vectors of the same size are copied in place, so this does not allocate.
+            frames_.writeBuffer() = lightingManager_.getFrameBuffer();
+            frames_.publish();
+            { std::lock_guard<std::mutex> lock(frameReadyMutex_); }
+            frameReady_.notify_one();
+        }
+
+        // Idle: nothing can change until a key is pressed, so sleep until one is.
+        if (lightingManager_.isIdle()) {
+            idle_.store(true, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(inputReadyMutex_);
+            inputReady_.wait(lock, [this] {
+                return !events_.empty() || !running_.load(std::memory_order_relaxed);
+            });
+            idle_.store(false, std::memory_order_relaxed);
+            pacer.resync();
+        }
+    }
+}
+
+void Pipeline::outputStage() {
+    while (running_.load(std::memory_order_relaxed)) {
+        bool published;
+        {
+            std::unique_lock<std::mutex> lock(frameReadyMutex_);
+            published = frameReady_.wait_for(
+                lock, std::chrono::milliseconds(IDLE_WAIT_TIMEOUT_MS), [this] {
+                    return frames_.hasNew() || !running_.load(std::memory_order_relaxed);
+                });
+        }
+        if (!published || !frames_.acquire()) {
+            // No new frame: hand the device the one it shows with nothing
+            // changed, so backends with a keep-alive (DmxOutput) keep sending.
+            if (running_.load(std::memory_order_relaxed)) {
+                changedKeys_.clear();
+                hardware_.renderChanges(sentFrame_, changedKeys_);
+            }
+            continue;
+        }
+
+        // Frames may have been skipped, so diff against what the device shows.
+        const std::vector<Color>& frame = frames_.readBuffer();
+        changedKeys_.clear();
+        for (size_t i = 0; i < frame.size(); ++i) {
+            if (frame[i] != sentFrame_[i]) {
+                sentFrame_[i] = frame[i];
+                changedKeys_.insert(i);
+            }
+        }
+        RIPPLEFX_PROFILE_SCOPE(ProfileStage::Render);
+        hardware_.renderChanges(frame, changedKeys_);
+    }
+}
+
+#endif
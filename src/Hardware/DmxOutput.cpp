@@ -0,0 +1,332 @@
+#if !defined(_WIN32)
+
+#include "Hardware/DmxOutput.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+// --- E1.31 (sACN) Layout ---
+// Root layer, framing layer and DMP layer, followed by the start code and the
+// 512 channel values. Offsets are from the start of the UDP payload.
+constexpr size_t SACN_PACKET_SIZE = 638;
+constexpr size_t SACN_CID_OFFSET = 22;
+constexpr size_t SACN_SOURCE_NAME_OFFSET = 44;
+constexpr size_t SACN_SOURCE_NAME_SIZE = 64;
+constexpr size_t SACN_SEQUENCE_OFFSET = 111;
+constexpr size_t SACN_UNIVERSE_OFFSET = 113;
+constexpr size_t SACN_DATA_OFFSET = 126;
+constexpr uint8_t SACN_PRIORITY = 100;
+
+// --- Art-Net ArtDmx Layout ---
+constexpr size_t ARTNET_PACKET_SIZE = 530;
+constexpr size_t ARTNET_SEQUENCE_OFFSET = 12;
+constexpr size_t ARTNET_DATA_OFFSET = 18;
+constexpr uint16_t ARTNET_OPCODE_DMX = 0x5000;
+constexpr uint8_t ARTNET_PROTOCOL_VERSION = 14;
+
+constexpr char SOURCE_NAME[] = "RippleFX";
+
+void writeU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value >> 8);
+    out[1] = static_cast<uint8_t>(value);
+}
+
+void writeU32(uint8_t* out, uint32_t value) {
+    writeU16(out, static_cast<uint16_t>(value >> 16));
+    writeU16(out + 2, static_cast<uint16_t>(value));
+}
+
+// The "flags and length" field of an ACN PDU: the length from `offset` to the end of the packet.
+uint16_t pduFlagsAndLength(size_t offset) {
+    return static_cast<uint16_t>(0x7000 | (SACN_PACKET_SIZE - offset));
+}
+
+} // namespace
+
+std::vector<DmxOutput::Patch> DmxOutput::linearPatch(size_t keyCount, uint16_t firstUniverse, size_t copies) {
+    std::vector<Patch> patch;
+    patch.reserve(keyCount * copies);
+    for (size_t copy = 0; copy < copies; ++copy) {
+        for (size_t key = 0; key < keyCount; ++key) {
+            const size_t pixel = copy * keyCount + key;
+            patch.push_back({
+                static_cast<uint16_t>(key),
+                static_cast<uint16_t>(firstUniverse + pixel / KEYS_PER_UNIVERSE),
+                static_cast<uint16_t>(1 + (pixel % KEYS_PER_UNIVERSE) * 3) });
+        }
+    }
+    return patch;
+}
+
+DmxOutput::DmxOutput(Protocol protocol, std::vector<Patch> patch, const char* host, uint16_t port)
+    : protocol_(protocol),
+    patch_(std::move(patch)),
+    host_(host ? host : ""),
+    port_(port != 0 ? port : protocol == Protocol::Sacn ? SACN_PORT : ARTNET_PORT)
+{
+}
+
+DmxOutput::~DmxOutput() {
+    if (socket_ >= 0) {
+        ::close(socket_);
+    }
+}
+
+bool DmxOutput::initialize() {
+    in_addr unicast{};
+    if (!host_.empty() && inet_pton(AF_INET, host_.c_str(), &unicast) != 1) {
+        std::cerr << "[DmxOutput] Invalid IPv4 address '" << host_ << "'." << std::endl;
+        return false;
+    }
+    if (host_.empty() && protocol_ == Protocol::ArtNet) {
+        std::cerr << "[DmxOutput] Art-Net needs a destination address." << std::endl;
+        return false;
+    }
+
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0) {
+        std::cerr << "[DmxOutput] Could not open a UDP socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // Art-Net is commonly sent to a broadcast address such as 2.255.255.255.
+    const int enable = 1;
+    ::setsockopt(socket_, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+    // A random component identifier per session, as E1.31 asks of every source.
+    std::random_device random;
+    for (size_t i = 0; i < sizeof(cid_); i += 4) {
+        const uint32_t bits = random();
+        std::memcpy(cid_ + i, &bits, 4);
+    }
+
+    // --- Universes ---
+    // One per distinct universe number in the patch, in increasing order.
+    std::vector<uint16_t> numbers;
+    for (const Patch& entry : patch_) {
+        numbers.push_back(entry.universe);
+    }
+    std::sort(numbers.begin(), numbers.end());
+    numbers.erase(std::unique(numbers.begin(), numbers.end()), numbers.end());
+
+    universes_.assign(numbers.size(), Universe{});
+    for (size_t u = 0; u < numbers.size(); ++u) {
+        Universe& universe = universes_[u];
+        universe.number = numbers[u];
+        buildPacket(universe);
+
+        universe.address.sin_family = AF_INET;
+        universe.address.sin_port = htons(port_);
+        if (host_.empty()) {
+            // sACN multicast: 239.255.<universe high byte>.<universe low byte>.
+            universe.address.sin_addr.s_addr = htonl(0xEFFF0000u | universe.number);
+        }
+        else {
+            universe.address.sin_addr = unicast;
+        }
+    }
+
+    // --- Patch ---
+    const size_t dataOffset = protocol_ == Protocol::Sacn ? SACN_DATA_OFFSET : ARTNET_DATA_OFFSET;
+    slots_.clear();
+    slots_.reserve(patch_.size());
+    for (const Patch& entry : patch_) {
+        if (entry.channel < 1 || entry.channel + 2u > CHANNELS_PER_UNIVERSE) {
+            std::cerr << "[DmxOutput] Channel " << entry.channel << " of universe " << entry.universe
+                << " is out of range; entry ignored." << std::endl;
+            continue;
+        }
+        const size_t u = static_cast<size_t>(std::lower_bound(numbers.begin(), numbers.end(), entry.universe) - numbers.begin());
+        slots_.push_back({ entry.keyIndex, static_cast<uint16_t>(u), static_cast<uint32_t>(dataOffset + entry.channel - 1) });
+    }
+    // Grouped by universe, so a frame walks each packet in order.
+    std::sort(slots_.begin(), slots_.end(), [](const Slot& a, const Slot& b) {
+        return a.universe != b.universe ? a.universe < b.universe : a.offset < b.offset;
+    });
+
+    // --- Batch Storage ---
+    // Every message of a batch points at a universe's packet and address, which never move.
+    dueUniverses_.reserve(universes_.size());
+    iovecs_.resize(universes_.size());
+    for (size_t u = 0; u < universes_.size(); ++u) {
+        iovecs_[u].iov_base = universes_[u].packet.data();
+        iovecs_[u].iov_len = universes_[u].packet.size();
+    }
+#if defined(__linux__)
+    messages_.assign(universes_.size(), mmsghdr{});
+#endif
+
+    stats_ = Stats{};
+    std::cout << "[DmxOutput] Hardware Initialized: " << (protocol_ == Protocol::Sacn ? "sACN" : "Art-Net") << ", "
+        << universes_.size() << " universes, " << slots_.size() << " patched keys, port " << port_ << "." << std::endl;
+    return true;
+}
+
+void DmxOutput::shutdown() {
+    std::cout << "[DmxOutput] " << stats_.frames << " frames, " << stats_.packets << " packets in "
+        << stats_.sendCalls << " send calls, " << stats_.unchangedSkipped << " unchanged universes skipped, "
+        << stats_.sendErrors << " send errors." << std::endl;
+    if (socket_ >= 0) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+    std::cout << "[DmxOutput] Hardware Shutdown." << std::endl;
+}
+
+void DmxOutput::render(const std::vector<Color>& frameBuffer) {
+    writeFrame(frameBuffer);
+    sendDue();
+}
+
+void DmxOutput::renderChanges(const std::vector<Color>& frameBuffer, const KeySet& dirtyKeys) {
+    if (!dirtyKeys.empty()) {
+        writeFrame(frameBuffer);
+    }
+    // Called even for a still frame, so keep-alive packets keep flowing.
+    sendDue();
+}
+
+void DmxOutput::getKeyboardState(KeyMask& pressed) const {
+    pressed.clear();
+}
+
+void DmxOutput::buildPacket(Universe& universe) const {
+    if (protocol_ == Protocol::Sacn) {
+        std::vector<uint8_t>& p = universe.packet;
+        p.assign(SACN_PACKET_SIZE, 0);
+
+        // Root layer.
+        writeU16(&p[0], 0x0010); // Preamble size.
+        writeU16(&p[2], 0x0000); // Postamble size.
+        std::memcpy(&p[4], "ASC-E1.17\0\0\0", 12);
+        writeU16(&p[16], pduFlagsAndLength(16));
+        writeU32(&p[18], 0x00000004); // VECTOR_ROOT_E131_DATA
+        std::memcpy(&p[SACN_CID_OFFSET], cid_, sizeof(cid_));
+
+        // Framing layer.
+        writeU16(&p[38], pduFlagsAndLength(38));
+        writeU32(&p[40], 0x00000002); // VECTOR_E131_DATA_PACKET
+        std::memcpy(&p[SACN_SOURCE_NAME_OFFSET], SOURCE_NAME, std::min(sizeof(SOURCE_NAME), SACN_SOURCE_NAME_SIZE));
+        p[108] = SACN_PRIORITY;
+        writeU16(&p[109], 0); // No synchronization universe.
+        p[SACN_SEQUENCE_OFFSET] = 0;
+        p[112] = 0; // Options.
+        writeU16(&p[SACN_UNIVERSE_OFFSET], universe.number);
+
+        // DMP layer.
+        writeU16(&p[115], pduFlagsAndLength(115));
+        p[117] = 0x02; // VECTOR_DMP_SET_PROPERTY
+        p[118] = 0xA1; // Address and data type.
+        writeU16(&p[119], 0x0000); // First property address.
+        writeU16(&p[121], 0x0001); // Address increment.
+        writeU16(&p[123], static_cast<uint16_t>(CHANNELS_PER_UNIVERSE + 1)); // Start code and channels.
+        p[125] = 0x00; // DMX start code.
+    }
+    else {
+        std::vector<uint8_t>& p = universe.packet;
+        p.assign(ARTNET_PACKET_SIZE, 0);
+
+        std::memcpy(&p[0], "Art-Net\0", 8);
+        p[8] = static_cast<uint8_t>(ARTNET_OPCODE_DMX & 0xFF); // The opcode is little-endian.
+        p[9] = static_cast<uint8_t>(ARTNET_OPCODE_DMX >> 8);
+        p[10] = 0;
+        p[11] = ARTNET_PROTOCOL_VERSION;
+        p[ARTNET_SEQUENCE_OFFSET] = 0;
+        p[13] = 0; // Physical port.
+        p[14] = static_cast<uint8_t>(universe.number & 0xFF); // SubUni.
+        p[15] = static_cast<uint8_t>((universe.number >> 8) & 0x7F); // Net.
+        writeU16(&p[16], static_cast<uint16_t>(CHANNELS_PER_UNIVERSE));
+    }
+}
+
+void DmxOutput::writeFrame(const std::vector<Color>& frameBuffer) {
+    for (const Slot& slot : slots_) {
+        if (slot.keyIndex >= frameBuffer.size()) continue;
+
+        const Color& color = frameBuffer[slot.keyIndex];
+        uint8_t* channels = universes_[slot.universe].packet.data() + slot.offset;
+        const uint8_t rgb[3] = { color.getRed(), color.getGreen(), color.getBlue() };
+        if (std::memcmp(channels, rgb, 3) != 0) {
+            std::memcpy(channels, rgb, 3);
+            universes_[slot.universe].changed = true;
+        }
+    }
+}
+
+void DmxOutput::sendDue() {
+    if (socket_ < 0) return;
+    ++stats_.frames;
+
+    // --- 1. Pick the universes to send ---
+    const Clock::time_point now = Clock::now();
+    dueUniverses_.clear();
+    for (size_t u = 0; u < universes_.size(); ++u) {
+        Universe& universe = universes_[u];
+        if (!universe.changed && now - universe.lastSent < KEEPALIVE_INTERVAL) {
+            ++stats_.unchangedSkipped;
+            continue;
+        }
+        universe.changed = false;
+        universe.lastSent = now;
+
+        // sACN sequence numbers wrap through 0; in Art-Net 0 means "not sequenced".
+        if (protocol_ == Protocol::Sacn) {
+            universe.packet[SACN_SEQUENCE_OFFSET] = ++universe.sequence;
+        }
+        else {
+            universe.sequence = static_cast<uint8_t>(universe.sequence == 255 ? 1 : universe.sequence + 1);
+            universe.packet[ARTNET_SEQUENCE_OFFSET] = universe.sequence;
+        }
+        dueUniverses_.push_back(u);
+    }
+    if (dueUniverses_.empty()) return;
+
+    // --- 2. Send them ---
+#if defined(__linux__)
+    for (size_t m = 0; m < dueUniverses_.size(); ++m) {
+        const size_t u = dueUniverses_[m];
+        msghdr& header = messages_[m].msg_hdr;
+        header = msghdr{};
+        header.msg_name = &universes_[u].address;
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov = &iovecs_[u];
+        header.msg_iovlen = 1;
+    }
+
+    // sendmmsg() may stop early; resume after the last packet it took, and
+    // skip a packet the socket refuses rather than stalling the frame on it.
+    size_t sent = 0;
+    while (sent < dueUniverses_.size()) {
+        ++stats_.sendCalls;
+        const int result = ::sendmmsg(socket_, &messages_[sent], static_cast<unsigned>(dueUniverses_.size() - sent), 0);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            ++stats_.sendErrors;
+            ++sent;
+            continue;
+        }
+        sent += static_cast<size_t>(result);
+        stats_.packets += static_cast<uint64_t>(result);
+    }
+#else
+    for (size_t u : dueUniverses_) {
+        ++stats_.sendCalls;
+        const Universe& universe = universes_[u];
+        const ssize_t result = ::sendto(socket_, universe.packet.data(), universe.packet.size(), 0,
+            reinterpret_cast<const sockaddr*>(&universe.address), sizeof(sockaddr_in));
+        if (result < 0) {
+            ++stats_.sendErrors;
+        }
+        else {
+            ++stats_.packets;
+        }
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,190 @@
+#if defined(__linux__)
+
+#include "Hardware/EvdevInput.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Newer kernel headers hide the timeval behind accessors on 32-bit targets.
+#if !defined(input_event_sec)
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+namespace {
+
+struct LinuxKeyMapping {
+    uint16_t linuxCode;
+    KeyCode code;
+};
+
+// Linux key codes (linux/input-event-codes.h) for every key of the layout.
+constexpr LinuxKeyMapping LINUX_KEY_MAP[] = {
+    // --- Alphanumeric Keys ---
+    { KEY_A, KeyCode::A }, { KEY_B, KeyCode::B }, { KEY_C, KeyCode::C }, { KEY_D, KeyCode::D },
+    { KEY_E, KeyCode::E }, { KEY_F, KeyCode::F }, { KEY_G, KeyCode::G }, { KEY_H, KeyCode::H },
+    { KEY_I, KeyCode::I }, { KEY_J, KeyCode::J }, { KEY_K, KeyCode::K }, { KEY_L, KeyCode::L },
+    { KEY_M, KeyCode::M }, { KEY_N, KeyCode::N }, { KEY_O, KeyCode::O }, { KEY_P, KeyCode::P },
+    { KEY_Q, KeyCode::Q }, { KEY_R, KeyCode::R }, { KEY_S, KeyCode::S }, { KEY_T, KeyCode::T },
+    { KEY_U, KeyCode::U }, { KEY_V, KeyCode::V }, { KEY_W, KeyCode::W }, { KEY_X, KeyCode::X },
+    { KEY_Y, KeyCode::Y }, { KEY_Z, KeyCode::Z },
+    { KEY_0, KeyCode::NUM_0 }, { KEY_1, KeyCode::NUM_1 }, { KEY_2, KeyCode::NUM_2 }, { KEY_3, KeyCode::NUM_3 },
+    { KEY_4, KeyCode::NUM_4 }, { KEY_5, KeyCode::NUM_5 }, { KEY_6, KeyCode::NUM_6 }, { KEY_7, KeyCode::NUM_7 },
+    { KEY_8, KeyCode::NUM_8 }, { KEY_9, KeyCode::NUM_9 },
+
+    // --- Function Keys ---
+    { KEY_F1, KeyCode::F1 }, { KEY_F2, KeyCode::F2 }, { KEY_F3, KeyCode::F3 }, { KEY_F4, KeyCode::F4 },
+    { KEY_F5, KeyCode::F5 }, { KEY_F6, KeyCode::F6 }, { KEY_F7, KeyCode::F7 }, { KEY_F8, KeyCode::F8 },
+    { KEY_F9, KeyCode::F9 }, { KEY_F10, KeyCode::F10 }, { KEY_F11, KeyCode::F11 }, { KEY_F12, KeyCode::F12 },
+
+    // --- Modifier Keys ---
+    { KEY_LEFTSHIFT, KeyCode::LEFT_SHIFT }, { KEY_RIGHTSHIFT, KeyCode::RIGHT_SHIFT },
+    { KEY_LEFTCTRL, KeyCode::LEFT_CONTROL }, { KEY_RIGHTCTRL, KeyCode::RIGHT_CONTROL },
+    { KEY_LEFTALT, KeyCode::LEFT_ALT }, { KEY_RIGHTALT, KeyCode::RIGHT_ALT },
+    { KEY_LEFTMETA, KeyCode::LEFT_WINDOWS }, { KEY_RIGHTMETA, KeyCode::RIGHT_WINDOWS },
+    { KEY_CAPSLOCK, KeyCode::CAPS_LOCK },
+
+    // --- Special Keys ---
+    { KEY_ESC, KeyCode::ESCAPE }, { KEY_SPACE, KeyCode::SPACE }, { KEY_ENTER, KeyCode::ENTER },
+    { KEY_BACKSPACE, KeyCode::BACKSPACE }, { KEY_TAB, KeyCode::TAB }, { KEY_COMPOSE, KeyCode::CONTEXT_MENU },
+
+    // --- Navigation and Editing ---
+    { KEY_INSERT, KeyCode::INSERT }, { KEY_DELETE, KeyCode::DELETE_KEY },
+    { KEY_HOME, KeyCode::HOME }, { KEY_END, KeyCode::END },
+    { KEY_PAGEUP, KeyCode::PAGE_UP }, { KEY_PAGEDOWN, KeyCode::PAGE_DOWN },
+    { KEY_UP, KeyCode::ARROW_UP }, { KEY_DOWN, KeyCode::ARROW_DOWN },
+    { KEY_LEFT, KeyCode::ARROW_LEFT }, { KEY_RIGHT, KeyCode::ARROW_RIGHT },
+
+    // --- System Keys ---
+    { KEY_SYSRQ, KeyCode::PRINT_SCREEN }, { KEY_SCROLLLOCK, KeyCode::SCROLL_LOCK }, { KEY_PAUSE, KeyCode::PAUSE_BREAK },
+
+    // --- Numpad Keys ---
+    { KEY_KP0, KeyCode::NUMPAD_0 }, { KEY_KP1, KeyCode::NUMPAD_1 }, { KEY_KP2, KeyCode::NUMPAD_2 },
+    { KEY_KP3, KeyCode::NUMPAD_3 }, { KEY_KP4, KeyCode::NUMPAD_4 }, { KEY_KP5, KeyCode::NUMPAD_5 },
+    { KEY_KP6, KeyCode::NUMPAD_6 }, { KEY_KP7, KeyCode::NUMPAD_7 }, { KEY_KP8, KeyCode::NUMPAD_8 },
+    { KEY_KP9, KeyCode::NUMPAD_9 }, { KEY_NUMLOCK, KeyCode::NUM_LOCK },
+    { KEY_KPSLASH, KeyCode::NUMPAD_DIVIDE }, { KEY_KPASTERISK, KeyCode::NUMPAD_MULTIPLY },
+    { KEY_KPMINUS, KeyCode::NUMPAD_SUBTRACT }, { KEY_KPPLUS, KeyCode::NUMPAD_ADD },
+    { KEY_KPENTER, KeyCode::NUMPAD_ENTER }, { KEY_KPDOT, KeyCode::NUMPAD_DECIMAL },
+
+    // --- OEM / Punctuation Keys ---
+    { KEY_GRAVE, KeyCode::OEM_TILDE }, { KEY_MINUS, KeyCode::OEM_MINUS }, { KEY_EQUAL, KeyCode::OEM_PLUS },
+    { KEY_LEFTBRACE, KeyCode::OEM_LBRACKET }, { KEY_RIGHTBRACE, KeyCode::OEM_RBRACKET },
+    { KEY_BACKSLASH, KeyCode::OEM_BACKSLASH }, { KEY_SEMICOLON, KeyCode::OEM_SEMICOLON },
+    { KEY_APOSTROPHE, KeyCode::OEM_QUOTE }, { KEY_COMMA, KeyCode::OEM_COMMA },
+    { KEY_DOT, KeyCode::OEM_PERIOD }, { KEY_SLASH, KeyCode::OEM_SLASH }, { KEY_102ND, KeyCode::OEM_102 }
+};
+
+// evdev values for EV_KEY events.
+constexpr int32_t EVDEV_RELEASE = 0;
+constexpr int32_t EVDEV_PRESS = 1;
+
+} // namespace
+
+EvdevInput::EvdevInput(const Keyboard& keyboard, const char* path)
+    : fd_(::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC))
+{
+    indexByLinuxCode_.fill(NO_KEY);
+    for (const LinuxKeyMapping& mapping : LINUX_KEY_MAP) {
+        const Key* key = keyboard.findKeyById(mapping.code);
+        if (key && mapping.linuxCode < LINUX_KEY_LIMIT) {
+            indexByLinuxCode_[mapping.linuxCode] = key->getIndex();
+        }
+    }
+
+    // Only a regular file ends at a read of 0 bytes. A FIFO reads 0 too while
+    // no writer has connected yet; it ends when poll() reports its hang-up.
+    struct stat info;
+    endsAtEof_ = fd_ >= 0 && ::fstat(fd_, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+EvdevInput::~EvdevInput() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void EvdevInput::pollEvents(KeyEventQueue& events, uint32_t /*nowMs*/) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    while (drainBuffer(events)) {
+        // Move a trailing partial record to the front, then top the buffer up.
+        const size_t pending = bufferEnd_ - bufferBegin_;
+        std::memmove(buffer_.data(), buffer_.data() + bufferBegin_, pending);
+        bufferBegin_ = 0;
+        bufferEnd_ = pending;
+
+        const ssize_t bytes = ::read(fd_, buffer_.data() + bufferEnd_, buffer_.size() - bufferEnd_);
+        if (bytes <= 0) {
+            // EAGAIN: nothing more for now. 0: the end of a recording, which
+            // stays readable forever, so the stream is closed and
+            // waitForEvents() stops reporting it as a source worth waiting on.
+            // On a FIFO, 0 only means no writer is connected right now.
+            if (bytes == 0 ? endsAtEof_ : (errno != EAGAIN && errno != EINTR)) {
+                closeStream();
+            }
+            return;
+        }
+        bufferEnd_ += static_cast<size_t>(bytes);
+    }
+}
+
+bool EvdevInput::waitForEvents(uint32_t timeoutMs) {
+    if (fd_ < 0) {
+        return false;
+    }
+    // Complete records already buffered (left over from a full queue) need no wait.
+    if (bufferEnd_ - bufferBegin_ >= sizeof(input_event)) {
+        return true;
+    }
+    pollfd descriptor{ fd_, POLLIN, 0 };
+    ::poll(&descriptor, 1, static_cast<int>(std::min<uint32_t>(timeoutMs, INT_MAX)));
+
+    // A hung-up or failed stream with nothing left to read would make every
+    // later poll() return at once: end it, and let the caller sleep instead.
+    // A FIFO only reports a hang-up once a writer has connected and left, so
+    // one waiting for its first writer simply times out here.
+    if ((descriptor.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0 && (descriptor.revents & POLLIN) == 0) {
+        closeStream();
+        return false;
+    }
+    return true;
+}
+
+void EvdevInput::closeStream() {
+    ::close(fd_);
+    fd_ = -1;
+}
+
+bool EvdevInput::drainBuffer(KeyEventQueue& events) {
+    while (bufferEnd_ - bufferBegin_ >= sizeof(input_event)) {
+        input_event raw;
+        std::memcpy(&raw, buffer_.data() + bufferBegin_, sizeof(raw));
+
+        const bool isKey = raw.type == EV_KEY && raw.code < LINUX_KEY_LIMIT
+            && (raw.value == EVDEV_PRESS || raw.value == EVDEV_RELEASE);
+        const uint16_t index = isKey ? indexByLinuxCode_[raw.code] : NO_KEY;
+
+        if (index != NO_KEY) {
+            KeyEvent event;
+            // Truncating to 32 bits is fine: consumers only compare nearby timestamps.
+            event.timestampMs = static_cast<uint32_t>(raw.input_event_sec * 1000 + raw.input_event_usec / 1000);
+            event.keyIndex = index;
+            event.action = raw.value == EVDEV_PRESS ? KeyAction::Press : KeyAction::Release;
+            if (!events.tryPush(event)) {
+                return false;
+            }
+        }
+        bufferBegin_ += sizeof(input_event);
+    }
+    return true;
+}
+
+#endif
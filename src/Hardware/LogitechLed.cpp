@@ -202,9 +202,9 @@ void LogitechLed::render(const std::vector<Color>& frameBuffer) {
         );
     }
 }
-std::vector<bool> LogitechLed::getKeyboardState() const {
-    // Crea un vettore per contenere lo stato di ogni tasto, inizializzato a 'false'.
-    std::vector<bool> keyStates(keyboard_->getKeys().size(), false);
+void LogitechLed::getKeyboardState(KeyMask& pressed) const {
+    // Start from an empty set: only keys found held down are added.
+    pressed.clear();
 
     // Itera attraverso la nostra mappa di traduzione.
     for (const auto& pair : vk_to_keycode_map) {
@@ -213,14 +213,15 @@ std::vector<bool> LogitechLed::getKeyboardState() const {
 
         // GetAsyncKeyState restituisce un valore il cui bit pi significativo  1 se il tasto  premuto.
         // Usiamo una maschera bit a bit per controllarlo.
-        if (GetAsyncKeyState(vk_code) & 0x8000) {
+        // The least significant bit is set if the key was pressed since the previous
+        // call: a tap shorter than the polling interval is reported as held once.
+        if (GetAsyncKeyState(vk_code) & 0x8001) {
             // Il tasto  premuto. Troviamo il suo oggetto Key nel nostro layout.
             const Key* key = keyboard_->findKeyById(key_code);
             if (key) {
-                // Impostiamo il valore corrispondente nel nostro vettore di stato a 'true'.
-                keyStates[key->getIndex()] = true;
+                // Add the key to the set of held keys.
+                pressed.set(key->getIndex());
             }
         }
     }
-    return keyStates;
 }
\ No newline at end of file
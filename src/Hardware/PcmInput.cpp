@@ -0,0 +1,96 @@
+#if !defined(_WIN32)
+
+#include "Hardware/PcmInput.h"
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PcmInput::PcmInput(const char* path, uint32_t sampleRate)
+    : ring_(sampleRate)
+{
+    if (std::strcmp(path, "-") == 0) {
+        fd_ = STDIN_FILENO;
+    }
+    else {
+        fd_ = ::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        ownsFd_ = fd_ >= 0;
+    }
+    if (fd_ < 0 || sampleRate == 0) {
+        ring_.close();
+        return;
+    }
+
+    struct stat info;
+    paced_ = ::fstat(fd_, &info) == 0 && S_ISREG(info.st_mode);
+    thread_ = std::thread(&PcmInput::run, this);
+}
+
+PcmInput::~PcmInput() {
+    running_.store(false, std::memory_order_relaxed);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (ownsFd_) {
+        ::close(fd_);
+    }
+}
+
+void PcmInput::run() {
+    // A regular file is played against the clock from here, by the total
+    // sample count, so rounding never accumulates into drift.
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t samplesRead = 0;
+
+    // Raw bytes; an odd byte left over from one read is kept for the next.
+    std::array<unsigned char, BLOCK_SAMPLES * 2> bytes{};
+    std::array<int16_t, BLOCK_SAMPLES> samples{};
+    size_t pending = 0;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        if (!paced_) {
+            pollfd descriptor{ fd_, POLLIN, 0 };
+            if (::poll(&descriptor, 1, STOP_CHECK_INTERVAL_MS) <= 0) {
+                continue;
+            }
+        }
+
+        const ssize_t read = ::read(fd_, bytes.data() + pending, bytes.size() - pending);
+        if (read == 0) {
+            break; // End of the file, or the writer closed the pipe.
+        }
+        if (read < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            break;
+        }
+        pending += static_cast<size_t>(read);
+
+        // Little-endian bytes to samples, whatever the host's byte order.
+        const size_t count = pending / 2;
+        for (size_t i = 0; i < count; ++i) {
+            samples[i] = static_cast<int16_t>(static_cast<uint16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8)));
+        }
+        if (pending % 2 != 0) {
+            bytes[0] = bytes[pending - 1];
+        }
+        pending %= 2;
+
+        // A full ring means the consumer has stalled; these samples are dropped
+        // rather than delaying the ones after them.
+        ring_.push(samples.data(), count);
+
+        if (paced_) {
+            samplesRead += count;
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(static_cast<int64_t>(samplesRead * 1000000000ULL / ring_.getSampleRate())));
+        }
+    }
+    ring_.close();
+}
+
+#endif
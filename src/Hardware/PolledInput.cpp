@@ -0,0 +1,23 @@
+#include "Hardware/PolledInput.h"
+
+PolledInput::PolledInput(const IHardware& hardware)
+    : hardware_(hardware)
+{
+}
+
+void PolledInput::pollEvents(KeyEventQueue& events, uint32_t nowMs) {
+    hardware_.getKeyboardState(current_);
+
+    // previous_ only changes once an event is queued, so a transition that did
+    // not fit in a full queue is found again, and reported, on the next poll.
+    current_.without(previous_).forEach([&](size_t index) {
+        if (events.tryPush({ nowMs, static_cast<uint16_t>(index), KeyAction::Press })) {
+            previous_.set(index);
+        }
+    });
+    previous_.without(current_).forEach([&](size_t index) {
+        if (events.tryPush({ nowMs, static_cast<uint16_t>(index), KeyAction::Release })) {
+            previous_.reset(index);
+        }
+    });
+}
@@ -0,0 +1,44 @@
+#include "Hardware/RecordingInput.h"
+
+RecordingInput::RecordingInput(IInputSource& source, const char* path, uint32_t seed)
+    : source_(source),
+    file_(std::fopen(path, "wb")),
+    writer_(seed)
+{
+    flush(); // Writes the header, so even an empty session leaves a valid trace.
+}
+
+RecordingInput::~RecordingInput() {
+    if (file_) {
+        flush();
+        std::fclose(file_);
+    }
+}
+
+void RecordingInput::pollEvents(KeyEventQueue& events, uint32_t nowMs) {
+    source_.pollEvents(staged_, nowMs);
+
+    // Events are recorded when they are forwarded, so the trace holds the poll
+    // that actually delivered each one to the engine.
+    while (hasPending_ || staged_.tryPop(pending_)) {
+        hasPending_ = true;
+        if (!events.tryPush(pending_)) {
+            break;
+        }
+        writer_.append(pollIndex_, pending_);
+        hasPending_ = false;
+    }
+    ++pollIndex_;
+
+    if (!writer_.getBytes().empty()) {
+        flush();
+    }
+}
+
+void RecordingInput::flush() {
+    if (file_) {
+        std::fwrite(writer_.getBytes().data(), 1, writer_.getBytes().size(), file_);
+        std::fflush(file_);
+    }
+    writer_.clear();
+}
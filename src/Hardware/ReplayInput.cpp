@@ -0,0 +1,39 @@
+#include "Hardware/ReplayInput.h"
+#include <cstdio>
+
+namespace {
+
+std::vector<uint8_t> readFile(const char* path) {
+    std::vector<uint8_t> bytes;
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return bytes;
+    }
+    uint8_t chunk[4096];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + count);
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+} // namespace
+
+ReplayInput::ReplayInput(const char* path)
+    : bytes_(readFile(path)),
+    reader_(Span<const uint8_t>(bytes_.data(), bytes_.size())),
+    open_(reader_.isValid())
+{
+    hasNext_ = reader_.next(nextPollIndex_, next_);
+}
+
+void ReplayInput::pollEvents(KeyEventQueue& events, uint32_t /*nowMs*/) {
+    while (hasNext_ && nextPollIndex_ <= pollIndex_) {
+        if (!events.tryPush(next_)) {
+            break;
+        }
+        hasNext_ = reader_.next(nextPollIndex_, next_);
+    }
+    ++pollIndex_;
+}
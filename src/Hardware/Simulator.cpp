@@ -1,54 +1,261 @@
 #include "Hardware/Simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
-Simulator::Simulator(const Keyboard* keyboard)
-    : keyboard_(keyboard)
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// --- Ansi Grid Geometry ---
+// One key unit is four columns wide and two rows tall, so half-unit offsets
+// (numpad, Enter) land on distinct cells. Each key is drawn three columns wide.
+constexpr float COLUMNS_PER_UNIT = 4.0f;
+constexpr float ROWS_PER_UNIT = 2.0f;
+constexpr char CELL_FILL[] = "   ";
+constexpr size_t CELL_WIDTH = sizeof(CELL_FILL) - 1;
+
+// "\x1b[RRRRR;CCCCCH" + "\x1b[48;2;RRR;GGG;BBBm" + the fill, rounded up.
+constexpr size_t MAX_CELL_BYTES = 48;
+constexpr size_t MAX_FRAME_OVERHEAD_BYTES = 64;
+
+constexpr char CLEAR_SCREEN[] = "\x1b[2J\x1b[?25l"; // Also hides the cursor.
+constexpr char RESET_COLOR[] = "\x1b[0m";
+
+char* appendLiteral(char* out, const char* text) {
+    const size_t length = std::strlen(text);
+    std::memcpy(out, text, length);
+    return out + length;
+}
+
+/**
+ * @brief Appends a number in decimal, without the locale and formatting machinery of printf.
+ */
+char* appendNumber(char* out, unsigned value) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+} // namespace
+
+Simulator::Simulator(const Keyboard* keyboard, Mode mode)
+    : keyboard_(keyboard),
+    mode_(mode)
 {
+    if (keyboard_ && mode_ == Mode::Ansi) {
+        buildAnsiGrid();
+    }
 }
 
 bool Simulator::initialize() {
     std::cout << "[Simulator] Hardware Initialized." << std::endl;
+
+    if (mode_ == Mode::Ansi && keyboard_) {
+#if defined(_WIN32)
+        // Windows consoles interpret escape sequences only when asked to.
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD consoleMode = 0;
+        if (GetConsoleMode(console, &consoleMode)) {
+            SetConsoleMode(console, consoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+#endif
+        // Start from a cleared screen with every key drawn black.
+        char* out = appendLiteral(ansiBuffer_.data(), CLEAR_SCREEN);
+        lastCellColor_ = Color(0, 0, 0, 0);
+        for (size_t i = 0; i < cells_.size(); ++i) {
+            shownColors_[i] = Color(0, 0, 0);
+            out = appendCell(out, i, shownColors_[i]);
+        }
+        flushAnsi(appendLiteral(out, RESET_COLOR));
+    }
     return true;
 }
 
 void Simulator::shutdown() {
+    if (mode_ == Mode::Ansi && keyboard_) {
+        // Leave the cursor below the grid, visible and with default colors.
+        char* out = appendLiteral(ansiBuffer_.data(), RESET_COLOR);
+        out = appendLiteral(out, "\x1b[");
+        out = appendNumber(out, gridRows_ + 2u);
+        out = appendLiteral(out, ";1H\x1b[?25h");
+        flushAnsi(out);
+    }
     std::cout << "[Simulator] Hardware Shutdown." << std::endl;
 }
 
 void Simulator::render(const std::vector<Color>& frameBuffer) {
     if (!keyboard_) return;
 
-    std::cout << "--- Frame " << frameCount_ << " ---" << std::endl;
     const auto& keys = keyboard_->getKeys();
 
+    if (mode_ == Mode::Ansi) {
+        // Without a dirty set, compare every key against what is on screen.
+        char* out = ansiBuffer_.data();
+        lastCellColor_ = Color(0, 0, 0, 0);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (frameBuffer[i] != shownColors_[i]) {
+                shownColors_[i] = frameBuffer[i];
+                out = appendCell(out, i, frameBuffer[i]);
+            }
+        }
+        if (out != ansiBuffer_.data()) {
+            flushAnsi(appendLiteral(out, RESET_COLOR));
+        }
+        return;
+    }
+
+    std::cout << "--- Frame " << frameCount_ << " ---" << '\n';
     for (size_t i = 0; i < keys.size(); ++i) {
         const Color& c = frameBuffer[i];
         // Only print keys that are not black to keep the output clean.
         if (c.getRed() > 0 || c.getGreen() > 0 || c.getBlue() > 0) {
-            std::cout << "  Key ID " << keys[i].getId() << " | Color: " << c.toHex() << std::endl;
+            std::cout << "  Key ID " << keys[i].getId() << " | Color: " << c.toHex() << '\n';
         }
     }
+    // One flush per frame instead of one per line.
+    std::cout.flush();
 }
-std::vector<bool> Simulator::getKeyboardState() const {
-    if (!keyboard_) {
-        return {};
+
+void Simulator::renderChanges(const std::vector<Color>& frameBuffer, const KeySet& dirtyKeys) {
+    if (!keyboard_ || dirtyKeys.empty()) return;
+
+    if (mode_ == Mode::Ansi) {
+        char* out = ansiBuffer_.data();
+        lastCellColor_ = Color(0, 0, 0, 0);
+        for (uint16_t i : dirtyKeys) {
+            if (frameBuffer[i] != shownColors_[i]) {
+                shownColors_[i] = frameBuffer[i];
+                out = appendCell(out, i, frameBuffer[i]);
+            }
+        }
+        if (out != ansiBuffer_.data()) {
+            flushAnsi(appendLiteral(out, RESET_COLOR));
+        }
+        return;
+    }
+
+    std::cout << "--- Frame " << frameCount_ << " (" << dirtyKeys.size() << " keys changed) ---" << '\n';
+    const auto& keys = keyboard_->getKeys();
+
+    // Keys that went dark are printed too, so the log reflects every transition.
+    for (uint16_t i : dirtyKeys) {
+        std::cout << "  Key ID " << keys[i].getId() << " | Color: " << frameBuffer[i].toHex() << '\n';
     }
+    std::cout.flush();
+}
 
-    // Create a vector to hold the state of every key, initialized to 'false'.
-    std::vector<bool> keyStates(keyboard_->getKeys().size(), false);
+void Simulator::getKeyboardState(KeyMask& pressed) const {
+    pressed.clear();
+    if (!keyboard_) {
+        return;
+    }
 
     frameCount_++;
     // Every 150 frames, we'll simulate pressing the 'G' key.
     if (frameCount_ % 150 == 0) {
-        std::cout << "\n*** SIMULATING KEY PRESS: 'G' ***\n" << std::endl;
-        
+        // The grid owns the terminal in Ansi mode; text would tear it.
+        if (mode_ == Mode::Log) {
+            std::cout << "\n*** SIMULATING KEY PRESS: 'G' ***\n" << std::endl;
+        }
+
         // Find the 'G' key in the layout.
         const Key* g_key = keyboard_->findKeyById(KeyCode::G);
         if (g_key) {
-            // Set the state for that specific key to 'true'.
-            keyStates[g_key->getIndex()] = true;
+            // Mark that specific key as held down.
+            pressed.set(g_key->getIndex());
         }
     }
+}
 
-    return keyStates;
-}
\ No newline at end of file
+void Simulator::buildAnsiGrid() {
+    const auto keys = keyboard_->getKeys();
+
+    float minX = 0.0f;
+    float minY = 0.0f;
+    if (!keys.empty()) {
+        minX = keys[0].getPosition().getX();
+        minY = keys[0].getPosition().getY();
+        for (const Key& key : keys) {
+            minX = std::min(minX, key.getPosition().getX());
+            minY = std::min(minY, key.getPosition().getY());
+        }
+    }
+
+    cells_.reserve(keys.size());
+    for (const Key& key : keys) {
+        Cell cell;
+        cell.row = static_cast<uint16_t>(1 + std::lround((key.getPosition().getY() - minY) * ROWS_PER_UNIT));
+        cell.column = static_cast<uint16_t>(1 + std::lround((key.getPosition().getX() - minX) * COLUMNS_PER_UNIT));
+        gridRows_ = std::max(gridRows_, cell.row);
+        cells_.push_back(cell);
+    }
+
+    shownColors_.assign(keys.size(), Color(0, 0, 0));
+    ansiBuffer_.resize(keys.size() * MAX_CELL_BYTES + MAX_FRAME_OVERHEAD_BYTES);
+}
+
+char* Simulator::appendCell(char* out, size_t index, const Color& color) {
+    const Cell& cell = cells_[index];
+    *out++ = '\x1b';
+    *out++ = '[';
+    out = appendNumber(out, cell.row);
+    *out++ = ';';
+    out = appendNumber(out, cell.column);
+    *out++ = 'H';
+
+    // Neighboring cells of a ripple often share a color; set it only when it changes.
+    if (color != lastCellColor_) {
+        out = appendLiteral(out, "\x1b[48;2;");
+        out = appendNumber(out, color.getRed());
+        *out++ = ';';
+        out = appendNumber(out, color.getGreen());
+        *out++ = ';';
+        out = appendNumber(out, color.getBlue());
+        *out++ = 'm';
+        lastCellColor_ = color;
+    }
+
+    std::memcpy(out, CELL_FILL, CELL_WIDTH);
+    return out + CELL_WIDTH;
+}
+
+void Simulator::flushAnsi(const char* end) {
+    // Anything still buffered by iostreams must reach the terminal first.
+    std::cout.flush();
+
+    const char* data = ansiBuffer_.data();
+    size_t remaining = static_cast<size_t>(end - data);
+    while (remaining > 0) {
+#if defined(_WIN32)
+        const int written = _write(1, data, static_cast<unsigned>(remaining));
+        if (written <= 0) {
+            return;
+        }
+#else
+        const ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+#endif
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
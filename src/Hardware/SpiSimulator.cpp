@@ -0,0 +1,67 @@
+#include "Hardware/SpiSimulator.h"
+#include <algorithm>
+#include <iostream>
+
+SpiSimulator::SpiSimulator(const LedEncoder& encoder, uint32_t clockHz)
+    : encoder_(encoder),
+    clockHz_(clockHz),
+    wire_(encoder.data().size(), 0)
+{
+}
+
+bool SpiSimulator::initialize() {
+    stats_ = Stats{};
+    std::cout << "[SpiSimulator] Hardware Initialized: " << encoder_.getKeyCount() << " LEDs, "
+        << encoder_.data().size() << " bytes per frame." << std::endl;
+    return true;
+}
+
+void SpiSimulator::shutdown() {
+    // Bits on the wire divided by the clock rate.
+    const double wireMs = static_cast<double>(stats_.bytes) * 8.0 * 1000.0 / clockHz_;
+    const double perFrameUs = stats_.frames == 0 ? 0.0 : wireMs * 1000.0 / static_cast<double>(stats_.frames);
+    std::cout << "[SpiSimulator] " << stats_.frames << " frames, " << stats_.bytes << " bytes, "
+        << stats_.mismatchedBytes << " mismatched bytes. Wire time at " << clockHz_ / 1000 << " kHz: "
+        << perFrameUs << " us per frame." << std::endl;
+    std::cout << "[SpiSimulator] Hardware Shutdown." << std::endl;
+}
+
+void SpiSimulator::render(const std::vector<Color>& frameBuffer) {
+    // The transfer: a straight copy of the encoder's buffer, with no conversion.
+    const auto data = encoder_.data();
+    std::copy(data.begin(), data.end(), wire_.begin());
+    ++stats_.frames;
+    stats_.bytes += data.size();
+    stats_.mismatchedBytes += verify(frameBuffer);
+}
+
+void SpiSimulator::getKeyboardState(KeyMask& pressed) const {
+    pressed.clear();
+}
+
+uint64_t SpiSimulator::verify(const std::vector<Color>& frameBuffer) const {
+    const WireFormat& format = encoder_.getFormat();
+    const size_t ledCount = encoder_.getKeyCount();
+    const size_t bytesPerLed = format.bytesPerLed();
+    uint64_t mismatches = 0;
+
+    // Header: zeros. Trailer: ones. Both are fixed for the whole session.
+    const size_t trailerStart = format.headerBytes() + ledCount * bytesPerLed;
+    for (size_t b = 0; b < format.headerBytes(); ++b) {
+        mismatches += wire_[b] != 0x00;
+    }
+    for (size_t b = trailerStart; b < wire_.size(); ++b) {
+        mismatches += wire_[b] != 0xFF;
+    }
+
+    // Every pixel, at its key's position on the strip.
+    uint8_t expected[4];
+    for (size_t i = 0; i < ledCount && i < frameBuffer.size(); ++i) {
+        format.encodePixel(frameBuffer[i], expected);
+        const uint8_t* actual = wire_.data() + encoder_.pixelOffset(i);
+        for (size_t b = 0; b < bytesPerLed; ++b) {
+            mismatches += actual[b] != expected[b];
+        }
+    }
+    return mismatches;
+}
@@ -5,110 +5,409 @@
 
 #include "Core/Keyboard/Keyboard.h"
 #include "Core/Lighting/LightingManager.h"
-#include "Core/Effects/RippleEffect.h"
+#include "Core/Lighting/RippleSpawner.h"
+#include "Core/Output/LedEncoder.h"
+#include "Core/Util/Profiler.h"
+#include "Engine/FramePacer.h"
+#include "Engine/Pipeline.h"
+#include "Hardware/DmxOutput.h"
+#include "Hardware/EvdevInput.h"
 #include "Hardware/IHardware.h"
+#include "Hardware/PcmInput.h"
+#include "Hardware/PolledInput.h"
+#include "Hardware/RecordingInput.h"
+#include "Hardware/ReplayInput.h"
+#include "Hardware/Simulator.h"
+#include "Hardware/SpiSimulator.h"
+#if defined(RIPPLEFX_WITH_LOGITECH)
 #include "Hardware/LogitechLed.h"
+#endif
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
-#include <thread>
+#include <random>
 #include <chrono>
-#include <algorithm>
+#include <thread>
 
  // --- High-Precision Timing Configuration ---
-constexpr int TARGET_FPS = 60;
-constexpr auto FRAME_DURATION = std::chrono::nanoseconds(1000000000 / TARGET_FPS);
-// We use a compile-time constant for the frame duration in milliseconds for fast integer math.
-// 1000 / 60 = 16. This is what we will divide by using a bit shift.
-constexpr int FRAME_DURATION_MS = 16;
+constexpr int DEFAULT_TARGET_FPS = 60;
+
+// --- Audio Configuration ---
+constexpr int DEFAULT_AUDIO_RATE = 44100;
+const Color SPECTRUM_COLOR(0, 160, 255);
+
+/**
+ * @brief Folds a frame into a running FNV-1a hash, to compare replays frame for frame.
+ */
+static uint64_t hashFrame(uint64_t hash, const std::vector<Color>& frame) {
+    for (const Color& color : frame) {
+        for (uint8_t channel : { color.getRed(), color.getGreen(), color.getBlue() }) {
+            hash = (hash ^ channel) * 0x100000001B3ULL;
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief The stage lighting protocol chosen on the command line, if any.
+ */
+enum class DmxProtocolChoice { None, Sacn, ArtNet };
+
+/**
+ * @brief Looks up an LED wire format by name: "ws2812", "apa102" or "rgb565".
+ * @return false if the name is unknown.
+ */
+static bool parseWireFormat(const char* name, WireFormat& format) {
+    if (std::strcmp(name, "ws2812") == 0) {
+        format = WireFormat::ws2812();
+    } else if (std::strcmp(name, "apa102") == 0) {
+        format = WireFormat::apa102();
+    } else if (std::strcmp(name, "rgb565") == 0) {
+        format = WireFormat::rgb565();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#if defined(RIPPLEFX_PROFILE)
+// Set once the stats reporter is running, for the SIGUSR1 handler.
+static std::atomic<StatsReporter*> g_statsReporter{ nullptr };
+
+/**
+ * @brief SIGUSR1 handler: asks the reporter thread for a stats dump.
+ */
+static void requestStatsDump(int) {
+    if (StatsReporter* reporter = g_statsReporter.load()) {
+        reporter->requestDump();
+    }
+}
+#endif
 
 /**
  * @brief The main entry point of the application.
+ *
+ * By default input, simulation and device output run as a pipeline on three
+ * threads. Pass `--single-threaded` to run them one after the other on the
+ * main thread instead, like the firmware does. On Linux, `--evdev <path>` reads
+ * key events from an evdev device node, FIFO or recording instead of polling
+ * the hardware. `--fps <n>` sets the target frame rate.
+ *
+ * `--record <path>` saves every key event to a trace file (and runs on a single
+ * thread, so the trace is in step with the frames), and `--replay <path>`
+ * plays one back deterministically on a single thread, printing a hash of all
+ * the frames at the end; add `--unpaced` to replay as fast as possible, as a
+ * benchmark. `--seed <n>` fixes the ripple colors of a live session.
+ * `--ripple-field` runs all the ripples in one shared RippleFieldEffect, so
+ * fast typing never costs more per frame and never drops a ripple.
+ * `--sparks <n>` also sends n sparks flying out of every pressed key.
+ *
+ * `--audio <path|->` turns the keyboard into a spectrum analyzer, fed with raw
+ * signed 16-bit little-endian mono PCM from a file, a FIFO or stdin (POSIX
+ * only); `--audio-rate <hz>` gives its sample rate (44100 by default). With
+ * `--audio -` stdin carries the audio, so the pipeline runs until it ends
+ * instead of until Enter is pressed.
+ *
+ * On Windows the Logitech backend is used unless `--simulator` is given; other
+ * platforms always use the console Simulator. `--ansi` makes the Simulator draw
+ * a live, colored keyboard in the terminal instead of logging text (and implies
+ * `--simulator`).
+ *
+ * `--spi <ws2812|apa102|rgb565>` drives a simulated addressable LED strip
+ * instead: the LightingManager encodes the changed keys straight into the
+ * strip's wire format, and the SpiSimulator checks every byte it sends. It has
+ * no keys of its own, so pair it with `--replay` or `--evdev`. It runs on a
+ * single thread, like the firmware.
+ *
+ * `--sacn <address|multicast>` or `--artnet <address>` mirror the keyboard onto
+ * stage lighting (POSIX only). `--dmx-port <n>` overrides the UDP port, e.g. to
+ * test against a local receiver, and `--dmx-copies <n>` patches n copies of the
+ * keyboard onto consecutive universes.
+ *
+ * Builds configured with RIPPLEFX_PROFILE print per-stage latency histograms
+ * to stderr on SIGUSR1 (POSIX), every `--stats <seconds>`, and after a replay.
  */
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "RippleEffectEngine starting up..." << std::endl;
+    bool singleThreaded = false;
+    bool unpaced = false;
+    bool useSimulator = false;
+    bool useRippleField = false;
+    int sparksPerPress = 0;
+    const char* audioPath = nullptr;
+    int audioRate = DEFAULT_AUDIO_RATE;
+    Simulator::Mode simulatorMode = Simulator::Mode::Log;
+    const char* evdevPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* spiFormatName = nullptr;
+    const char* dmxHost = nullptr;
+    DmxProtocolChoice dmxProtocol = DmxProtocolChoice::None;
+    int dmxPort = 0;
+    int dmxCopies = 1;
+    int targetFps = DEFAULT_TARGET_FPS;
+    uint32_t seed = std::random_device{}();
+    int statsInterval = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--single-threaded") == 0) {
+            singleThreaded = true;
+        } else if (std::strcmp(argv[i], "--evdev") == 0 && i + 1 < argc) {
+            evdevPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            targetFps = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--unpaced") == 0) {
+            unpaced = true;
+        } else if (std::strcmp(argv[i], "--ripple-field") == 0) {
+            useRippleField = true;
+        } else if (std::strcmp(argv[i], "--sparks") == 0 && i + 1 < argc) {
+            sparksPerPress = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--audio") == 0 && i + 1 < argc) {
+            audioPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--audio-rate") == 0 && i + 1 < argc) {
+            audioRate = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--simulator") == 0) {
+            useSimulator = true;
+        } else if (std::strcmp(argv[i], "--ansi") == 0) {
+            useSimulator = true;
+            simulatorMode = Simulator::Mode::Ansi;
+        } else if (std::strcmp(argv[i], "--spi") == 0 && i + 1 < argc) {
+            spiFormatName = argv[++i];
+        } else if (std::strcmp(argv[i], "--sacn") == 0 && i + 1 < argc) {
+            dmxProtocol = DmxProtocolChoice::Sacn;
+            dmxHost = argv[++i];
+        } else if (std::strcmp(argv[i], "--artnet") == 0 && i + 1 < argc) {
+            dmxProtocol = DmxProtocolChoice::ArtNet;
+            dmxHost = argv[++i];
+        } else if (std::strcmp(argv[i], "--dmx-port") == 0 && i + 1 < argc) {
+            dmxPort = std::max(0, std::min(65535, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--dmx-copies") == 0 && i + 1 < argc) {
+            dmxCopies = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsInterval = std::max(0, std::atoi(argv[++i]));
+        }
+    }
+    // A trace holds one input poll per simulation frame, which only the
+    // single-threaded loop guarantees: the pipelined input thread polls on its own clock.
+    if (recordPath) {
+        singleThreaded = true;
+    }
 
     // --- 1. Initialization ---
     Keyboard keyboard;
-    std::unique_ptr<IHardware> hardware = std::make_unique<LogitechLed>(&keyboard);
+    std::unique_ptr<LedEncoder> ledEncoder;
+    std::unique_ptr<IHardware> hardware;
+    if (spiFormatName) {
+        // An LED strip in key order, fed from a wire-format buffer that is kept up to date by the simulation.
+        WireFormat format;
+        if (!parseWireFormat(spiFormatName, format)) {
+            std::cerr << "ERROR: Unknown LED format '" << spiFormatName << "' (use ws2812, apa102 or rgb565). Exiting." << std::endl;
+            return 1;
+        }
+        ledEncoder = std::make_unique<LedEncoder>(format, keyboard.getKeys().size());
+        hardware = std::make_unique<SpiSimulator>(*ledEncoder);
+        singleThreaded = true;
+    } else if (dmxProtocol != DmxProtocolChoice::None) {
+#if !defined(_WIN32)
+        // Stage lighting: sACN universes 1 and up, Art-Net port addresses 0 and up.
+        const bool sacn = dmxProtocol == DmxProtocolChoice::Sacn;
+        hardware = std::make_unique<DmxOutput>(
+            sacn ? DmxOutput::Protocol::Sacn : DmxOutput::Protocol::ArtNet,
+            DmxOutput::linearPatch(keyboard.getKeys().size(), sacn ? 1 : 0, static_cast<size_t>(dmxCopies)),
+            sacn && std::strcmp(dmxHost, "multicast") == 0 ? nullptr : dmxHost,
+            static_cast<uint16_t>(dmxPort));
+#else
+        std::cerr << "ERROR: sACN and Art-Net output are not available on Windows. Exiting." << std::endl;
+        return 1;
+#endif
+    } else {
+#if defined(RIPPLEFX_WITH_LOGITECH)
+        if (useSimulator) {
+            hardware = std::make_unique<Simulator>(&keyboard, simulatorMode);
+        } else {
+            hardware = std::make_unique<LogitechLed>(&keyboard);
+        }
+#else
+        // Without the Logitech SDK (e.g. on Linux) the console simulator stands in for the device.
+        (void)useSimulator;
+        hardware = std::make_unique<Simulator>(&keyboard, simulatorMode);
+#endif
+    }
 
     if (!hardware->initialize()) {
-        std::cerr << "ERROR: Could not initialize hardware. Check that G HUB is running. Exiting." << std::endl;
+        std::cerr << "ERROR: Could not initialize hardware. If it is a Logitech keyboard, check that G HUB is running. Exiting." << std::endl;
         std::cin.get();
         return 1;
     }
 
-    LightingManager lightingManager(&keyboard);
-    std::cout << "System initialized. Starting main loop." << std::endl;
+    // Key events come from the hardware's key-state snapshots, unless an evdev stream is given.
+    std::unique_ptr<IInputSource> input = std::make_unique<PolledInput>(*hardware);
+#if defined(__linux__)
+    if (evdevPath) {
+        auto evdev = std::make_unique<EvdevInput>(keyboard, evdevPath);
+        if (!evdev->isOpen()) {
+            std::cerr << "ERROR: Could not open evdev input '" << evdevPath << "'. Exiting." << std::endl;
+            return 1;
+        }
+        input = std::move(evdev);
+    }
+#else
+    if (evdevPath) {
+        std::cerr << "WARNING: --evdev is only supported on Linux; polling the keyboard instead." << std::endl;
+    }
+#endif
+
+    // A replay takes the place of live input and runs with the recorded seed.
+    std::unique_ptr<ReplayInput> replay;
+    if (replayPath) {
+        replay = std::make_unique<ReplayInput>(replayPath);
+        if (!replay->isOpen()) {
+            std::cerr << "ERROR: '" << replayPath << "' is not a valid trace. Exiting." << std::endl;
+            return 1;
+        }
+        seed = replay->getSeed();
+    }
 
-    auto last_update_time = std::chrono::high_resolution_clock::now();
-    std::vector<bool> previous_key_state(keyboard.getKeys().size(), false);
-    auto last_press_time = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<RecordingInput> recorder;
+    if (recordPath) {
+        recorder = std::make_unique<RecordingInput>(replay ? static_cast<IInputSource&>(*replay) : *input, recordPath, seed);
+        if (!recorder->isOpen()) {
+            std::cerr << "ERROR: Could not create trace '" << recordPath << "'. Exiting." << std::endl;
+            return 1;
+        }
+    }
 
-    // --- 2. Main Application Loop (Non-Blocking) ---
-    while (true) {
-        auto current_time = std::chrono::high_resolution_clock::now();
-        if (current_time - last_update_time >= FRAME_DURATION) {
-            last_update_time = current_time;
-
-            // --- 3. Input Handling ---
-            std::vector<bool> current_key_state = hardware->getKeyboardState();
-            const auto& keys = keyboard.getKeys();
-
-            for (size_t i = 0; i < keys.size(); ++i) {
-                if (current_key_state[i] && !previous_key_state[i]) {
-                    const Key& pressedKey = keys[i];
-
-                    // --- 4. DYNAMIC EFFECT CREATION ---
-                    auto now = std::chrono::high_resolution_clock::now();
-                    auto time_since_last_press = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_press_time);
-                    last_press_time = now;
-
-                    // Use 'long long' for the intermediate calculation. This is the safest approach
-                    // to prevent an integer overflow bug if the time since the last press is very long.
-                    long long lifetime_ms = (time_since_last_press.count() << 1);
-
-                    // Clamp the value to a sensible range. The 'LL' suffix ensures the numbers
-                    // are treated as long long, preventing compiler warnings.
-                    lifetime_ms = std::max(500LL, std::min(7000LL, lifetime_ms));
-
-                    // Convert lifetime in milliseconds to frames using a fast bit shift (division by 16).
-                    int maxLifetime = lifetime_ms >> 4;
-
-                    // Map typing speed to wave propagation speed.
-                    int propagationDelay = 5;
-                    if (time_since_last_press.count() < 150) propagationDelay = 1;
-                    else if (time_since_last_press.count() < 250) propagationDelay = 2;
-                    else if (time_since_last_press.count() < 350) propagationDelay = 3;
-                    else if (time_since_last_press.count() < 500) propagationDelay = 4;
-
-                    // Calculate fade duration using a fast bit shift (division by 8).
-                    int stepDuration = std::max(1, maxLifetime >> 3);
-
-                    std::cout << "\n*** KEY PRESS DETECTED (ID " << pressedKey.getId() << ") ***" << std::endl;
-                    std::cout << "  > Time since last press: " << time_since_last_press.count() << "ms" << std::endl;
-                    std::cout << "  > New Lifetime: " << maxLifetime << " frames" << std::endl;
-                    std::cout << "  > New Propagation Delay: " << propagationDelay << std::endl;
-                    std::cout << "  > New Fade Step Duration: " << stepDuration << std::endl;
-
-                    lightingManager.addRippleEffect(
-                        pressedKey,
-                        Color::randomColor(),
-                        stepDuration,
-                        propagationDelay,
-                        maxLifetime
-                    );
-                }
+    IInputSource& source = recorder ? static_cast<IInputSource&>(*recorder)
+        : replay ? static_cast<IInputSource&>(*replay) : *input;
+
+    // The audio reader is started before the LightingManager, so its ring outlives the analyzer.
+    PcmRing* audioRing = nullptr;
+#if !defined(_WIN32)
+    std::unique_ptr<PcmInput> audio;
+    if (audioPath) {
+        audio = std::make_unique<PcmInput>(audioPath, static_cast<uint32_t>(audioRate));
+        if (!audio->isOpen()) {
+            std::cerr << "ERROR: Could not open audio input '" << audioPath << "'. Exiting." << std::endl;
+            return 1;
+        }
+        audioRing = &audio->getRing();
+    }
+#else
+    if (audioPath) {
+        std::cerr << "ERROR: --audio is not available on Windows. Exiting." << std::endl;
+        return 1;
+    }
+#endif
+
+    // The sparks and the analyzer get a pool slot only when this session uses them.
+    const SharedEffects sharedEffects = (sparksPerPress > 0 ? SharedEffects::Sparks : SharedEffects::None)
+        | (audioRing ? SharedEffects::Spectrum : SharedEffects::None);
+    LightingManager lightingManager(&keyboard, MAX_ACTIVE_EFFECTS, EvictionPolicy::StealOldest, sharedEffects);
+    if (audioRing) {
+        lightingManager.addSpectrum(*audioRing, SPECTRUM_COLOR);
+    }
+    if (ledEncoder) {
+        lightingManager.setLedEncoder(ledEncoder.get());
+    }
+    RippleSpawner spawner(lightingManager, 0, seed);
+    spawner.setUseRippleField(useRippleField);
+    spawner.setSparksPerPress(static_cast<size_t>(sparksPerPress));
+    const auto frameDuration = std::chrono::nanoseconds(1000000000LL / targetFps);
+    Pipeline pipeline(keyboard, source, *hardware, lightingManager, spawner, frameDuration);
+
+#if defined(RIPPLEFX_PROFILE)
+    // Stats are formatted and written on the reporter's own thread, never in the frame loop.
+    // Static, so it outlives every exit path that a late signal could race with.
+    static StatsReporter statsReporter(std::cerr, std::chrono::seconds(statsInterval));
+    g_statsReporter.store(&statsReporter);
+#if !defined(_WIN32)
+    std::signal(SIGUSR1, requestStatsDump);
+#endif
+#else
+    (void)statsInterval;
+#endif
+
+    // --- 2a. Replay ---
+    // One poll per frame, exactly like the single-threaded loop that can record
+    // the trace, so every frame matches the recording.
+    if (replay) {
+        std::cout << "Replaying '" << replayPath << "'." << std::endl;
+        FramePacer pacer(targetFps);
+        uint64_t frameHash = 0xCBF29CE484222325ULL;
+        uint32_t frames = 0;
+        const auto start_time = std::chrono::steady_clock::now();
+
+        while (!replay->isFinished() || !pipeline.isIdle()) {
+            if (!unpaced) {
+                pacer.wait();
+                RIPPLEFX_PROFILE_PACER(PacedLoop::Frame, pacer);
             }
-            previous_key_state = current_key_state;
+            // Replayed events carry their own timestamps; this clock is only nominal.
+            pipeline.runFrame(static_cast<uint32_t>(frames * 1000ULL / targetFps));
+            frameHash = hashFrame(frameHash, lightingManager.getFrameBuffer());
+            ++frames;
+        }
 
-            // --- 5. Logic Update & 6. Rendering ---
-            lightingManager.update();
-            hardware->render(lightingManager.getFrameBuffer());
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+        std::cout << "Replayed " << frames << " frames in " << elapsed.count() << " us. Frame hash: "
+            << std::hex << frameHash << std::dec << std::endl;
+#if defined(RIPPLEFX_PROFILE)
+        Profiler::instance().dump(std::cerr);
+#endif
+        hardware->shutdown();
+        return 0;
+    }
+
+    // --- 2b. Pipelined Mode ---
+    if (!singleThreaded) {
+        pipeline.start();
+        if (audioRing && std::strcmp(audioPath, "-") == 0) {
+            std::cout << "System initialized. Pipeline running until the audio ends." << std::endl;
+            while (!audioRing->isFinished()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        } else {
+            std::cout << "System initialized. Pipeline running; press Enter to quit." << std::endl;
+            std::cin.get();
         }
+        pipeline.stop();
+        hardware->shutdown();
+        return 0;
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(0));
+    // --- 2c. Single-Threaded Main Loop ---
+    // The pacer sleeps until just before each frame's deadline and spins only
+    // for the last moment, so the loop neither drifts nor burns a core.
+    std::cout << "System initialized. Starting main loop." << std::endl;
+    const auto start_time = std::chrono::steady_clock::now();
+    FramePacer pacer(targetFps);
+
+    while (true) {
+        pacer.wait();
+        RIPPLEFX_PROFILE_PACER(PacedLoop::Frame, pacer);
+
+        // --- 3. Input, Logic Update & Rendering ---
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+        pipeline.runFrame(static_cast<uint32_t>(elapsed.count()));
+
+        // --- 4. Idle ---
+        // Nothing is animating and no key is pending: block until there is input.
+        if (pipeline.isIdle()) {
+            if (pipeline.waitForInput()) {
+                pacer.resync();
+            }
+        }
     }
 
     hardware->shutdown();
     return 0;
-}
\ No newline at end of file
+}
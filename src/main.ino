@@ -5,10 +5,15 @@
 // --- Core Engine Includes ---
 // These are your platform-independent library files.
 // You would need to add your Core/ library to the Arduino/PlatformIO project.
+// Build the whole project with RIPPLEFX_SINGLE_THREADED defined (e.g. in the
+// build flags), so the Pipeline is compiled without its threaded mode.
 #include "Core/Keyboard/Keyboard.h"
 #include "Core/Lighting/LightingManager.h"
-#include "Core/Effects/RippleEffect.h"
+#include "Core/Lighting/RippleSpawner.h"
+#include "Core/Output/LedEncoder.h"
+#include "Engine/Pipeline.h"
 #include "Hardware/IHardware.h"
+#include "Hardware/PolledInput.h"
 
 // --- ESP32 Hardware Implementation (Placeholder) ---
 // You would create these files to control your specific hardware (e.g., NeoPixel LEDs)
@@ -25,9 +30,16 @@
 
 Keyboard keyboard;
 LightingManager lightingManager(&keyboard);
+RippleSpawner spawner(lightingManager);
 
-// The hardware pointer will be assigned in setup().
+// The frame in the LED strip's wire format (pick your strip's format), ready
+// for DMA. The LightingManager rewrites only the keys that change, so the
+// hardware's render() just starts a transfer of ledEncoder.data().
+LedEncoder ledEncoder(WireFormat::ws2812(), keyboard.getKeys().size());
+
+// The hardware pointer will be assigned in setup(), and the pipeline built on it.
 IHardware* hardware;
+Pipeline* pipeline;
 
 // --- Timing Configuration ---
 constexpr int TARGET_FPS = 60;
@@ -35,8 +47,6 @@ constexpr unsigned long FRAME_INTERVAL_MS = 1000 / TARGET_FPS;
 
 // --- State Variables ---
 unsigned long last_update_time = 0;
-std::vector<bool> previous_key_state;
-unsigned long last_press_time = 0;
 
 
 // =========================================================================
@@ -49,7 +59,7 @@ void setup() {
     // <<< YOU MUST IMPLEMENT THIS >>>
     // Create an instance of your concrete hardware implementation for the ESP32.
     // For example:
-    // hardware = new ESP32_NeoPixel(&keyboard);
+    // hardware = new ESP32_NeoPixel(ledEncoder);
 
     // Initialize the hardware.
     if (!hardware->initialize()) {
@@ -57,12 +67,20 @@ void setup() {
         while(true) {} // Halt execution
     }
 
-    // Initialize the state vectors after the keyboard is fully constructed.
-    previous_key_state.resize(keyboard.getKeys().size(), false);
+    lightingManager.setLedEncoder(&ledEncoder);
+
+    // One shared ripple field: a burst of fast typing costs no more per frame
+    // than a single press, and no press is ever dropped.
+    spawner.setUseRippleField(true);
+
+    // The input source and the pipeline are created once, at boot, and live forever.
+    static PolledInput input(*hardware);
+    static Pipeline firmwarePipeline(keyboard, input, *hardware, lightingManager, spawner,
+        std::chrono::milliseconds(FRAME_INTERVAL_MS));
+    pipeline = &firmwarePipeline;
 
     // Initialize the timers.
     last_update_time = millis();
-    last_press_time = millis();
 
     // Optional: Start serial communication for debugging.
     // Serial.begin(115200);
@@ -82,49 +100,9 @@ void loop() {
     if (current_time - last_update_time >= FRAME_INTERVAL_MS) {
         last_update_time = current_time; // Reset the timer for the next frame.
 
-        // --- 3. Input Handling ---
-        std::vector<bool> current_key_state = hardware->getKeyboardState();
-        const auto& keys = keyboard.getKeys();
-
-        for (size_t i = 0; i < keys.size(); ++i) {
-            // Detect a new key press (rising edge).
-            if (current_key_state[i] && !previous_key_state[i]) {
-                const Key& pressedKey = keys[i];
-                
-                // --- 4. DYNAMIC EFFECT CREATION ---
-                unsigned long now = millis();
-                unsigned long time_since_last_press = now - last_press_time;
-                last_press_time = now;
-
-                long long lifetime_ms = (time_since_last_press << 1);
-                lifetime_ms = std::max(500LL, std::min(7000LL, lifetime_ms));
-
-                int maxLifetime = lifetime_ms >> 4; // Fast division by 16
-
-                int propagationDelay = 5;
-                if (time_since_last_press < 150) propagationDelay = 1;
-                else if (time_since_last_press < 250) propagationDelay = 2;
-                else if (time_since_last_press < 350) propagationDelay = 3;
-                else if (time_since_last_press < 500) propagationDelay = 4;
-
-                int stepDuration = std::max(1, maxLifetime >> 3); // Fast division by 8
-
-                lightingManager.addRippleEffect(
-                    pressedKey,
-                    Color::randomColor(),
-                    stepDuration,
-                    propagationDelay,
-                    maxLifetime
-                );
-            }
-        }
-        previous_key_state = current_key_state;
-
-        // --- 5. Logic Update ---
-        lightingManager.update();
-
-        // --- 6. Rendering ---
-        const std::vector<Color>& frame = lightingManager.getFrameBuffer();
-        hardware->render(frame);
+        // --- 3. Input, 4. Logic Update & 5. Rendering ---
+        // Key presses start ripples shaped by the typing rhythm, and only frames
+        // with changed keys reach the LEDs; an idle keyboard costs nothing.
+        pipeline->runFrame(static_cast<uint32_t>(current_time));
     }
 }
\ No newline at end of file